@@ -0,0 +1,302 @@
+///Benchmark of timSort, std::stable_sort and std::sort on all element types of tests.h, several input distributions and sizes 10, 100, ...
+///For each case prints median and 99th percentile of wall time of one sort (after warmup), number of comparisons and, for timSort,
+///number of element moves (from TimSortStats); output is JSON: {"results": [{...}, ...]}
+///argv = [name, maxNumberOfElements, numberOfTrials]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../timsort.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_WARMUP_TRIALS = 2;
+
+///Small arrays are sorted many times in each trial, so that trial takes measurable time
+const size_t MIN_ELEMENTS_PER_TRIAL = 100000;
+
+const size_t STRING_LENGTH = 16;
+
+const size_t NUMBER_OF_UNIQUE_ELEMENTS = 8;
+
+const size_t NUMBER_OF_PARTS = 16;
+
+const size_t NUMBER_OF_TEETH = 8;
+
+
+template<class ElementType>
+std::vector<ElementType> generateRandomArray(size_t numberOfElements)
+{
+    std::vector<ElementType> result(numberOfElements);
+    std::generate(result.begin(), result.end(), TimsortRand::GenerateElement<ElementType>());
+    return result;
+}
+
+template<>
+std::vector<std::string> generateRandomArray<std::string>(size_t numberOfElements)
+{
+    std::vector<std::string> result(numberOfElements);
+    std::generate(result.begin(), result.end(), TimsortRand::GenerateElement<std::string>(STRING_LENGTH));
+    return result;
+}
+
+///Sorts consecutive parts of array of partSize elements
+template<class ElementType, class Compare>
+void sortParts(std::vector<ElementType> &array, size_t partSize, Compare comp)
+{
+    for (size_t begin = 0; begin < array.size(); begin += partSize)
+    {
+        std::stable_sort(array.begin() + begin, array.begin() + std::min(begin + partSize, array.size()), comp);
+    }
+}
+
+const char * const DISTRIBUTIONS[] = {
+                                      "random", "sorted", "reversed", "partlySorted",
+                                      "fewUnique", "sawtooth", "organPipe", "appendToSorted"
+                                     };
+
+template<class ElementType, class Compare>
+std::vector<ElementType> generateArray(const std::string &distribution, size_t numberOfElements, Compare comp)
+{
+    std::vector<ElementType> result = generateRandomArray<ElementType>(numberOfElements);
+    if (distribution == "sorted")
+    {
+        std::stable_sort(result.begin(), result.end(), comp);
+    }
+    else if (distribution == "reversed")
+    {
+        std::stable_sort(result.begin(), result.end(), comp);
+        std::reverse(result.begin(), result.end());
+    }
+    else if (distribution == "partlySorted")
+    {
+        sortParts(result, std::max<size_t>(1u, numberOfElements / NUMBER_OF_PARTS), comp);
+    }
+    else if (distribution == "fewUnique")
+    {
+        for (size_t i = 0; i < numberOfElements; ++i)
+        {
+            result[i] = result[TimsortRand::rand() % std::min(numberOfElements, NUMBER_OF_UNIQUE_ELEMENTS)];
+        }
+    }
+    else if (distribution == "sawtooth")
+    {
+        ///the same ascending sequence is repeated
+        size_t toothSize = std::max<size_t>(1u, numberOfElements / NUMBER_OF_TEETH);
+        std::stable_sort(result.begin(), result.begin() + toothSize, comp);
+        for (size_t i = toothSize; i < numberOfElements; ++i)
+        {
+            result[i] = result[i % toothSize];
+        }
+    }
+    else if (distribution == "organPipe")
+    {
+        ///ascending, then descending
+        std::stable_sort(result.begin(), result.end(), comp);
+        std::vector<ElementType> pipe;
+        pipe.reserve(numberOfElements);
+        for (size_t i = 0; i < numberOfElements; i += 2)
+        {
+            pipe.push_back(result[i]);
+        }
+        for (size_t i = numberOfElements - 1 - numberOfElements % 2; i < numberOfElements; i -= 2)
+        {
+            pipe.push_back(result[i]);
+        }
+        result.swap(pipe);
+    }
+    else if (distribution == "appendToSorted")
+    {
+        ///sorted array with 10% of random elements in the end
+        std::stable_sort(result.begin(), result.begin() + (numberOfElements - numberOfElements / 10), comp);
+    }
+    return result;
+}
+
+
+class TimSortAlgorithm
+{
+public:
+    static const char *getName()
+    {
+        return "timSort";
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void operator()(RandomAccessIterator first, RandomAccessIterator last, Compare comp) const
+    {
+        timSort(first, last, comp);
+    }
+};
+
+class StdStableSortAlgorithm
+{
+public:
+    static const char *getName()
+    {
+        return "std::stable_sort";
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void operator()(RandomAccessIterator first, RandomAccessIterator last, Compare comp) const
+    {
+        std::stable_sort(first, last, comp);
+    }
+};
+
+class StdSortAlgorithm
+{
+public:
+    static const char *getName()
+    {
+        return "std::sort";
+    }
+
+    template<class RandomAccessIterator, class Compare>
+    void operator()(RandomAccessIterator first, RandomAccessIterator last, Compare comp) const
+    {
+        std::sort(first, last, comp);
+    }
+};
+
+
+///Number of element moves is known only for timSort
+template<class Algorithm>
+class MovesCounter
+{
+public:
+    template<class ElementType, class Compare>
+    static bool countMoves(std::vector<ElementType>, Compare, unsigned long long &)
+    {
+        return false;
+    }
+};
+
+template<>
+class MovesCounter<TimSortAlgorithm>
+{
+public:
+    template<class ElementType, class Compare>
+    static bool countMoves(std::vector<ElementType> array, Compare comp, unsigned long long &moves)
+    {
+        TimSortFunctionsAndClasses::TimSortStats stats;
+        timSort(array.begin(), array.end(), comp, stats);
+        moves = stats.moves;
+        return true;
+    }
+};
+
+template<class ElementType, class Compare, class Algorithm>
+void measure(
+             const char *typeName, const char *distribution, const std::vector<ElementType> &array, Compare comp,
+             Algorithm sort, unsigned int numberOfTrials, const std::vector<ElementType> &sortedArray, bool &isFirstResult
+            )
+{
+    size_t numberOfElements = array.size();
+    size_t sortsPerTrial = std::max<size_t>(1u, MIN_ELEMENTS_PER_TRIAL / std::max<size_t>(1u, numberOfElements));
+    std::vector<double> times;
+
+    for (unsigned int trial = 0; trial < NUMBER_OF_WARMUP_TRIALS + numberOfTrials; ++trial)
+    {
+        std::vector<std::vector<ElementType> > arrays(sortsPerTrial, array);
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < sortsPerTrial; ++i)
+        {
+            sort(arrays[i].begin(), arrays[i].end(), comp);
+        }
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+        if (trial >= NUMBER_OF_WARMUP_TRIALS)
+        {
+            times.push_back(std::chrono::duration<double>(end - begin).count() / sortsPerTrial);
+        }
+        if (trial == 0)
+        {
+            for (size_t i = 0; i < numberOfElements; ++i)
+            {
+                if (comp(arrays[0][i], sortedArray[i]) || comp(sortedArray[i], arrays[0][i]))
+                {
+                    throw "Array is not sorted\n";
+                }
+            }
+        }
+    }
+    std::sort(times.begin(), times.end());
+
+    unsigned long long comparisons = 0;
+    std::vector<ElementType> arrayToCount = array;
+    sort(arrayToCount.begin(), arrayToCount.end(), TimSortFunctionsAndClasses::CountingComparator<Compare>(comp, &comparisons));
+    unsigned long long moves = 0;
+    bool areMovesKnown = MovesCounter<Algorithm>::countMoves(array, comp, moves);
+
+    printf(
+           "%s\n    {\"type\": \"%s\", \"distribution\": \"%s\", \"size\": %llu, \"algorithm\": \"%s\", \"trials\": %u, "
+           "\"medianSeconds\": %.9e, \"p99Seconds\": %.9e, \"comparisons\": %llu, \"moves\": ",
+           (isFirstResult ? "" : ","), typeName, distribution, static_cast<unsigned long long>(numberOfElements), Algorithm::getName(), numberOfTrials,
+           times[times.size() / 2], times[(times.size() * 99 + 99) / 100 - 1], comparisons
+          );
+    if (areMovesKnown)
+    {
+        printf("%llu}", moves);
+    }
+    else
+    {
+        printf("null}");
+    }
+    isFirstResult = false;
+}
+
+template<class ElementType, class Compare>
+void benchmarkType(const char *typeName, size_t maxNumberOfElements, unsigned int numberOfTrials, bool &isFirstResult, Compare comp = Compare())
+{
+    for (size_t numberOfElements = 10; numberOfElements <= maxNumberOfElements; numberOfElements *= 10)
+    {
+        for (size_t i = 0; i < sizeof(DISTRIBUTIONS) / sizeof(DISTRIBUTIONS[0]); ++i)
+        {
+            std::vector<ElementType> array = generateArray<ElementType>(DISTRIBUTIONS[i], numberOfElements, comp);
+            std::vector<ElementType> sortedArray = array;
+            std::stable_sort(sortedArray.begin(), sortedArray.end(), comp);
+
+            measure(typeName, DISTRIBUTIONS[i], array, comp, TimSortAlgorithm(), numberOfTrials, sortedArray, isFirstResult);
+            measure(typeName, DISTRIBUTIONS[i], array, comp, StdStableSortAlgorithm(), numberOfTrials, sortedArray, isFirstResult);
+            measure(typeName, DISTRIBUTIONS[i], array, comp, StdSortAlgorithm(), numberOfTrials, sortedArray, isFirstResult);
+            fflush(stdout);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t maxNumberOfElements = (argc > 1 ? strtoull(argv[1], 0, 10) : 100000u);
+    long long numberOfTrialsArgument = (argc > 2 ? strtoll(argv[2], 0, 10) : 5);
+    ///median and percentile of times need at least one measured trial
+    if (numberOfTrialsArgument < 1)
+    {
+        fprintf(stderr, "numberOfTrials shall be positive\n");
+        return 1;
+    }
+    unsigned int numberOfTrials = static_cast<unsigned int>(numberOfTrialsArgument);
+    bool isFirstResult = true;
+
+    try
+    {
+        printf("{\"results\": [");
+        benchmarkType<int, std::less<int> >("int", maxNumberOfElements, numberOfTrials, isFirstResult);
+        benchmarkType<std::string, std::less<std::string> >("string", maxNumberOfElements, numberOfTrials, isFirstResult);
+        benchmarkType<std::pair<unsigned int, int>, std::less<std::pair<unsigned int, int> > >("pair", maxNumberOfElements, numberOfTrials, isFirstResult);
+        benchmarkType<TimSortTestClasses::Point, TimSortTestClasses::PointComparator>("Point", maxNumberOfElements, numberOfTrials, isFirstResult);
+        benchmarkType<TimSortTestClasses::MoveCountingElement, std::less<TimSortTestClasses::MoveCountingElement> >(
+                                                                                                                   "MoveCountingElement", maxNumberOfElements,
+                                                                                                                   numberOfTrials, isFirstResult
+                                                                                                                  );
+        printf("\n]}\n");
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
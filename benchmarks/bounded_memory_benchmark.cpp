@@ -0,0 +1,86 @@
+///Time, peak merge buffer and element moves of timSort with merge buffer limited by setMaxBufferBytes,
+///compared with unlimited buffer and std::stable_sort, on random and partly sorted integers
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../timsort.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_PARTS = 16;
+
+std::vector<int> generateArray(unsigned int numberOfElements, unsigned int numberOfSortedParts)
+{
+    std::vector<int> result(numberOfElements);
+    std::generate(result.begin(), result.end(), TimsortRand::generateInt);
+    if (numberOfSortedParts > 0)
+    {
+        unsigned int partSize = std::max(1u, numberOfElements / numberOfSortedParts);
+        for (unsigned int begin = 0; begin < numberOfElements; begin += partSize)
+        {
+            std::sort(result.begin() + begin, result.begin() + std::min(begin + partSize, numberOfElements));
+        }
+    }
+    return result;
+}
+
+///maxBufferBytes == 0 means unlimited buffer
+void measureTimSort(const std::vector<int> &array, const std::vector<int> &sortedArray, size_t maxBufferBytes)
+{
+    std::vector<int> arrayToSort = array;
+    TimSortFunctionsAndClasses::TimSortWorkspace<std::vector<int>::iterator, TimSortFunctionsAndClasses::TimSortStats> workspace;
+    if (maxBufferBytes > 0)
+    {
+        workspace.setMaxBufferBytes(maxBufferBytes);
+    }
+
+    clock_t begin = clock();
+    timSort(arrayToSort.begin(), arrayToSort.end(), std::less<int>(), workspace);
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    if (arrayToSort != sortedArray)
+    {
+        throw "Array is not sorted\n";
+    }
+
+    const TimSortFunctionsAndClasses::TimSortStats &stats = workspace.getStats();
+    printf(
+           "    maxBufferBytes %12llu time %8.3lf peakBufferBytes %12llu moves %12llu\n",
+           static_cast<unsigned long long>(maxBufferBytes), time,
+           static_cast<unsigned long long>(stats.peakBufferBytes), stats.moves
+          );
+}
+
+void compare(const char *distributionName, const std::vector<int> &array)
+{
+    std::vector<int> sortedArray = array;
+    clock_t begin = clock();
+    std::stable_sort(sortedArray.begin(), sortedArray.end());
+    printf("%s: std::stable_sort %8.3lf\n", distributionName, double(clock() - begin) / CLOCKS_PER_SEC);
+
+    const size_t MAX_BUFFER_BYTES[] = {0u, 1u << 22, 1u << 16, 1u << 10, 1u};
+    for (size_t i = 0; i < sizeof(MAX_BUFFER_BYTES) / sizeof(MAX_BUFFER_BYTES[0]); ++i)
+    {
+        measureTimSort(array, sortedArray, MAX_BUFFER_BYTES[i]);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 4000000u);
+
+    try
+    {
+        compare("random", generateArray(numberOfElements, 0u));
+        compare("partlySorted", generateArray(numberOfElements, NUMBER_OF_PARTS));
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
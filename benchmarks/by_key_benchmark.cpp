@@ -0,0 +1,156 @@
+///Compares timSort with expensive comparators and timSortByKey with keys, which cache the expensive parts of comparisons:
+///Point and string test types and strings of decimal numbers, which are compared by values
+///argv = [name, numberOfElements, lengthOfStrings]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../timsort_by_key.h"
+#include "../tests.h"
+
+
+///Key of Point, in which isUp() is computed once
+class PointKey
+{
+public:
+    bool isUp;
+
+    TimSortTestClasses::Point point;
+};
+
+class PointKeyFunction
+{
+public:
+    PointKey operator()(const TimSortTestClasses::Point &point) const
+    {
+        PointKey result = {point.isUp(), point};
+        return result;
+    }
+};
+
+///The same order as TimSortTestClasses::PointComparator
+class PointKeyComparator
+{
+public:
+    bool operator()(const PointKey &a, const PointKey &b) const
+    {
+        if (a.isUp != b.isUp)
+        {
+            return a.isUp;
+        }
+        long long crossProduct = a.point * b.point;
+        if (crossProduct == 0)
+        {
+            return a.point.sqLen() < b.point.sqLen();
+        }
+        return crossProduct > 0;
+    }
+};
+
+///Strings are ordered by size, then lexicographically
+class StringComparator
+{
+public:
+    bool operator()(const std::string &first, const std::string &second) const
+    {
+        if (first.size() == second.size())
+        {
+            return first < second;
+        }
+        return first.size() < second.size();
+    }
+};
+
+///Key of string is its size and pointer to it, so sizes are compared without access to strings
+class StringKeyFunction
+{
+public:
+    std::pair<size_t, const std::string*> operator()(const std::string &value) const
+    {
+        return std::make_pair(value.size(), &value);
+    }
+};
+
+class StringKeyComparator
+{
+public:
+    bool operator()(const std::pair<size_t, const std::string*> &first, const std::pair<size_t, const std::string*> &second) const
+    {
+        if (first.first == second.first)
+        {
+            return *first.second < *second.second;
+        }
+        return first.first < second.first;
+    }
+};
+
+///Decimal numbers are compared by values, so comparator parses both strings on every call
+class NumberStringComparator
+{
+public:
+    bool operator()(const std::string &first, const std::string &second) const
+    {
+        return strtoll(first.c_str(), 0, 10) < strtoll(second.c_str(), 0, 10);
+    }
+};
+
+class NumberStringKeyFunction
+{
+public:
+    long long operator()(const std::string &value) const
+    {
+        return strtoll(value.c_str(), 0, 10);
+    }
+};
+
+template<class ElementType, class Compare, class KeyFunction, class KeyCompare>
+void compare(const char *typeName, const std::vector<ElementType> &array, Compare comp, KeyFunction keyFn, KeyCompare keyComp)
+{
+    std::vector<ElementType> sortedArray = array;
+    clock_t begin = clock();
+    timSort(sortedArray.begin(), sortedArray.end(), comp);
+    double sortTime = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    std::vector<ElementType> sortedByKeyArray = array;
+    begin = clock();
+    timSortByKey(sortedByKeyArray.begin(), sortedByKeyArray.end(), keyFn, keyComp);
+    double sortByKeyTime = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    for (size_t i = 0; i < array.size(); ++i)
+    {
+        if (comp(sortedArray[i], sortedByKeyArray[i]) || comp(sortedByKeyArray[i], sortedArray[i]))
+        {
+            throw "Results differ\n";
+        }
+    }
+    printf("%-8s timSort %8.3lf timSortByKey %8.3lf\n", typeName, sortTime, sortByKeyTime);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 1000000u);
+    unsigned int lengthOfStrings = (argc > 2 ? atoi(argv[2]) : 20u);
+
+    std::vector<TimSortTestClasses::Point> points(numberOfElements);
+    std::generate(points.begin(), points.end(), TimsortRand::GenerateElement<TimSortTestClasses::Point>());
+    compare("Point", points, TimSortTestClasses::PointComparator(), PointKeyFunction(), PointKeyComparator());
+
+    ///strings of different lengths, so that sizes decide most comparisons
+    std::vector<std::string> strings(numberOfElements);
+    for (size_t i = 0; i < strings.size(); ++i)
+    {
+        strings[i] = TimsortRand::GenerateElement<std::string>(1u + TimsortRand::rand() % lengthOfStrings)();
+    }
+    compare("string", strings, StringComparator(), StringKeyFunction(), StringKeyComparator());
+
+    std::vector<std::string> numbers(numberOfElements);
+    for (size_t i = 0; i < numbers.size(); ++i)
+    {
+        numbers[i] = std::to_string(TimsortRand::generateInt());
+    }
+    compare("number", numbers, NumberStringComparator(), NumberStringKeyFunction(), std::less<long long>());
+    return 0;
+}
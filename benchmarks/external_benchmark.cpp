@@ -0,0 +1,100 @@
+///Sorts a random file of 64-bit numbers with externalTimSort and checks the result
+///argv = [name, numberOfElements, memoryInMegabytes, fileNamePrefix]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "../timsort_external.h"
+#include "../tests.h"
+
+
+unsigned long long generateUnsignedLongLong()
+{
+    unsigned long long high = TimsortRand::rand();
+    return (high << 32) | TimsortRand::rand();
+}
+
+void generateFile(const std::string &fileName, unsigned long long numberOfElements)
+{
+    FILE *file = fopen(fileName.c_str(), "wb");
+    if (!file)
+    {
+        throw "Can't create input file\n";
+    }
+    std::vector<unsigned long long> block(1u << 16);
+    for (unsigned long long written = 0; written < numberOfElements; written += block.size())
+    {
+        size_t blockSize = std::min<unsigned long long>(block.size(), numberOfElements - written);
+        std::generate(block.begin(), block.begin() + blockSize, generateUnsignedLongLong);
+        fwrite(block.data(), sizeof(unsigned long long), blockSize, file);
+    }
+    fclose(file);
+}
+
+void checkFile(const std::string &fileName, unsigned long long numberOfElements)
+{
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (!file)
+    {
+        throw "Can't open sorted file\n";
+    }
+    std::vector<unsigned long long> block(1u << 16);
+    unsigned long long numberOfReadElements = 0;
+    unsigned long long previous = 0;
+    size_t blockSize;
+    while ((blockSize = fread(block.data(), sizeof(unsigned long long), block.size(), file)) > 0)
+    {
+        for (size_t i = 0; i < blockSize; ++i)
+        {
+            if (block[i] < previous)
+            {
+                fclose(file);
+                throw "File is not sorted\n";
+            }
+            previous = block[i];
+        }
+        numberOfReadElements += blockSize;
+    }
+    fclose(file);
+    if (numberOfReadElements != numberOfElements)
+    {
+        throw "Wrong number of elements in sorted file\n";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    unsigned long long numberOfElements = (argc > 1 ? strtoull(argv[1], 0, 10) : 100000000ull);
+    size_t memoryInMegabytes = (argc > 2 ? strtoull(argv[2], 0, 10) : 64u);
+    std::string fileNamePrefix = (argc > 3 ? argv[3] : "external_benchmark");
+    std::string inputFileName = fileNamePrefix + ".in";
+    std::string outputFileName = fileNamePrefix + ".out";
+
+    int exitCode = 0;
+    try
+    {
+        generateFile(inputFileName, numberOfElements);
+
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        externalTimSort<unsigned long long>(inputFileName, outputFileName, memoryInMegabytes << 20);
+        std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+        checkFile(outputFileName, numberOfElements);
+        printf(
+               "%llu elements, %u MB of memory: %.3lf s\n",
+               numberOfElements, (unsigned int)memoryInMegabytes, std::chrono::duration<double>(end - begin).count()
+              );
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        exitCode = 1;
+    }
+    ///files are removed also after a failure, so it doesn't leave gigabytes behind
+    remove(inputFileName.c_str());
+    remove(outputFileName.c_str());
+    return exitCode;
+}
@@ -0,0 +1,91 @@
+///Compares timSort, LSD radix sort and timSortHybrid on 32- and 64-bit integers:
+///random, partly sorted and long sorted runs mixed with random stretches
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../timsort_hybrid.h"
+#include "../tests.h"
+
+
+template<class ElementType>
+ElementType generateElement()
+{
+    return static_cast<ElementType>(TimsortRand::generateInt()) * static_cast<ElementType>(TimsortRand::generateInt());
+}
+
+///Sorted runs of runSize elements alternate with random stretches of stretchSize elements
+template<class ElementType>
+std::vector<ElementType> generateRunsAndRandomStretches(unsigned int numberOfElements, unsigned int runSize, unsigned int stretchSize)
+{
+    std::vector<ElementType> result(numberOfElements);
+    std::generate(result.begin(), result.end(), generateElement<ElementType>);
+    for (unsigned int begin = 0; begin < numberOfElements; begin += runSize + stretchSize)
+    {
+        std::sort(result.begin() + begin, result.begin() + std::min(begin + runSize, numberOfElements));
+    }
+    return result;
+}
+
+template<class ElementType, class Sort>
+double measure(std::vector<ElementType> array, const std::vector<ElementType> &sortedArray, Sort sort)
+{
+    clock_t begin = clock();
+    sort(array);
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    if (array != sortedArray)
+    {
+        throw "Array is not sorted\n";
+    }
+    return time;
+}
+
+template<class ElementType>
+void timSortVector(std::vector<ElementType> &array)
+{
+    timSort(array.begin(), array.end());
+}
+
+template<class ElementType>
+void radixSortVector(std::vector<ElementType> &array)
+{
+    TimSortFunctionsAndClasses::MergeState<ElementType> mergeState;
+    TimSortFunctionsAndClasses::radixSort(array.begin(), array.end(), mergeState, TimSortFunctionsAndClasses::IdentityKey());
+}
+
+template<class ElementType>
+void timSortHybridVector(std::vector<ElementType> &array)
+{
+    timSortHybrid(array.begin(), array.end());
+}
+
+template<class ElementType>
+void compare(const char *distributionName, const std::vector<ElementType> &array)
+{
+    std::vector<ElementType> sortedArray = array;
+    std::sort(sortedArray.begin(), sortedArray.end());
+    printf(
+           "%-24s timSort %8.3lf radixSort %8.3lf timSortHybrid %8.3lf\n",
+           distributionName,
+           measure(array, sortedArray, timSortVector<ElementType>),
+           measure(array, sortedArray, radixSortVector<ElementType>),
+           measure(array, sortedArray, timSortHybridVector<ElementType>)
+          );
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 4000000u);
+
+    const unsigned int RUN_SIZE = 100000u;
+    compare("int random", generateRunsAndRandomStretches<int>(numberOfElements, 0u, numberOfElements));
+    compare("int partlySorted", generateRunsAndRandomStretches<int>(numberOfElements, RUN_SIZE, 0u));
+    compare("int runsAndRandom", generateRunsAndRandomStretches<int>(numberOfElements, RUN_SIZE, RUN_SIZE));
+    compare("long long random", generateRunsAndRandomStretches<long long>(numberOfElements, 0u, numberOfElements));
+    compare("long long partlySorted", generateRunsAndRandomStretches<long long>(numberOfElements, RUN_SIZE, 0u));
+    compare("long long runsAndRandom", generateRunsAndRandomStretches<long long>(numberOfElements, RUN_SIZE, RUN_SIZE));
+    return 0;
+}
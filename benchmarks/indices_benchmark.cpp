@@ -0,0 +1,66 @@
+///Compares timSort of 200-byte records with timSortIndices (32-bit indices) followed by applyPermutation
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include "../timsort_by_key.h"
+#include "../tests.h"
+
+
+class Record
+{
+public:
+    unsigned int key;
+
+    char payload[196];
+};
+
+class RecordComparator
+{
+public:
+    bool operator()(const Record &first, const Record &second) const
+    {
+        return first.key < second.key;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 1000000u);
+
+    std::vector<Record> records(numberOfElements);
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        records[i].key = TimsortRand::generateUnsignedInt() % (numberOfElements / 4u + 1u);
+        memset(records[i].payload, static_cast<int>(i), sizeof(records[i].payload));
+    }
+
+    std::vector<Record> sortedRecords = records;
+    clock_t begin = clock();
+    timSort(sortedRecords.begin(), sortedRecords.end(), RecordComparator());
+    double sortTime = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    std::vector<Record> permutedRecords = records;
+    begin = clock();
+    std::vector<unsigned int> permutation = timSortIndices<unsigned int>(permutedRecords.begin(), permutedRecords.end(), RecordComparator());
+    double sortIndicesTime = double(clock() - begin) / CLOCKS_PER_SEC;
+    applyPermutation(permutedRecords.begin(), permutedRecords.end(), permutation);
+    double sortIndicesAndPermuteTime = double(clock() - begin) / CLOCKS_PER_SEC;
+
+    for (size_t i = 0; i < records.size(); ++i)
+    {
+        if (memcmp(&sortedRecords[i], &permutedRecords[i], sizeof(Record)) != 0)
+        {
+            throw "Results differ\n";
+        }
+    }
+    printf(
+           "timSort %8.3lf | timSortIndices %8.3lf, with applyPermutation %8.3lf\n",
+           sortTime, sortIndicesTime, sortIndicesAndPermuteTime
+          );
+    return 0;
+}
@@ -0,0 +1,88 @@
+///Compares timSortMergeK of sorted shards with concatenation of shards and timSort of the result
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../timsort_merge_k.h"
+#include "../tests.h"
+
+
+typedef std::vector<int>::const_iterator ShardIterator;
+
+///numberOfShards sorted shards of random values; if areShardsDisjoint, values of each shard are greater than values of previous ones
+std::vector<std::vector<int> > generateShards(unsigned int numberOfElements, unsigned int numberOfShards, bool areShardsDisjoint)
+{
+    std::vector<std::vector<int> > shards(numberOfShards);
+    for (unsigned int i = 0; i < numberOfShards; ++i)
+    {
+        shards[i].resize(numberOfElements / numberOfShards);
+        for (size_t j = 0; j < shards[i].size(); ++j)
+        {
+            int value = TimsortRand::rand() % 1000000000u;
+            shards[i][j] = (areShardsDisjoint ? value / numberOfShards + i * (1000000000 / numberOfShards) : value);
+        }
+        std::sort(shards[i].begin(), shards[i].end());
+    }
+    /// disjoint shards are stored in random order, so they are not concatenated in sorted order
+    std::random_shuffle(shards.begin(), shards.end());
+    return shards;
+}
+
+double measureConcatenateAndSort(const std::vector<std::vector<int> > &shards, std::vector<int> &result)
+{
+    clock_t begin = clock();
+    result.clear();
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        result.insert(result.end(), shards[i].begin(), shards[i].end());
+    }
+    timSort(result.begin(), result.end(), std::less<int>());
+    return double(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+double measureMergeK(const std::vector<std::vector<int> > &shards, std::vector<int> &result)
+{
+    clock_t begin = clock();
+    std::vector<std::pair<ShardIterator, ShardIterator> > ranges;
+    size_t numberOfElements = 0;
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        ranges.push_back(std::make_pair(shards[i].begin(), shards[i].end()));
+        numberOfElements += shards[i].size();
+    }
+    result.resize(numberOfElements);
+    timSortMergeK(ranges, result.begin(), std::less<int>());
+    return double(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+void compare(unsigned int numberOfElements, unsigned int numberOfShards, bool areShardsDisjoint)
+{
+    std::vector<std::vector<int> > shards = generateShards(numberOfElements, numberOfShards, areShardsDisjoint);
+    std::vector<int> sortResult, mergeResult;
+    double sortTime = measureConcatenateAndSort(shards, sortResult);
+    double mergeTime = measureMergeK(shards, mergeResult);
+    if (sortResult != mergeResult)
+    {
+        throw "Results differ\n";
+    }
+    printf(
+           "%5u %-8s shards: concatenate and timSort %8.3lf timSortMergeK %8.3lf\n",
+           numberOfShards, (areShardsDisjoint ? "disjoint" : "random"), sortTime, mergeTime
+          );
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 4000000u);
+    const unsigned int NUMBERS_OF_SHARDS[] = {2u, 8u, 64u, 1024u};
+
+    for (size_t i = 0; i < sizeof(NUMBERS_OF_SHARDS) / sizeof(NUMBERS_OF_SHARDS[0]); ++i)
+    {
+        compare(numberOfElements, NUMBERS_OF_SHARDS[i], false);
+        compare(numberOfElements, NUMBERS_OF_SHARDS[i], true);
+    }
+    return 0;
+}
@@ -0,0 +1,77 @@
+///Compares timSort and parallelTimSort with 2, 4, 8 and hardware_concurrency threads on random and partly sorted ints
+///Time is wall time (clock() would sum the time of all threads); link with -pthread
+///argv = [name, numberOfElements]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include "../timsort_parallel.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_PARTS = 16;
+
+template<class Sort>
+double measure(std::vector<int> array, const std::vector<int> &sortedArray, Sort sort)
+{
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    sort(array);
+    double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    if (array != sortedArray)
+    {
+        throw "Array is not sorted\n";
+    }
+    return time;
+}
+
+void compare(const char *distributionName, const std::vector<int> &array)
+{
+    std::vector<int> sortedArray = array;
+    std::sort(sortedArray.begin(), sortedArray.end());
+
+    printf(
+           "%-14s timSort %8.3lf", distributionName,
+           measure(array, sortedArray, [](std::vector<int> &array) { timSort(array.begin(), array.end()); })
+          );
+    unsigned int numbersOfThreads[] = {2u, 4u, 8u, std::max(1u, std::thread::hardware_concurrency())};
+    for (size_t i = 0; i < sizeof(numbersOfThreads) / sizeof(numbersOfThreads[0]); ++i)
+    {
+        unsigned int numberOfThreads = numbersOfThreads[i];
+        printf(
+               " threads %2u %8.3lf", numberOfThreads,
+               measure(
+                       array, sortedArray,
+                       [=](std::vector<int> &array) { parallelTimSort(array.begin(), array.end(), std::less<int>(), numberOfThreads); }
+                      )
+              );
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 10000000u);
+
+    std::vector<int> array(numberOfElements);
+    std::generate(array.begin(), array.end(), TimsortRand::generateInt);
+
+    try
+    {
+        compare("random", array);
+        size_t partSize = std::max(1u, numberOfElements / NUMBER_OF_PARTS);
+        for (size_t begin = 0; begin < array.size(); begin += partSize)
+        {
+            std::sort(array.begin() + begin, array.begin() + std::min(begin + partSize, array.size()));
+        }
+        compare("partlySorted", array);
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,86 @@
+///Finds the k least of numberOfElements unsigned ints by timSortPartial, std::partial_sort (not stable) and full timSort
+///on random, mostly sorted (a few random swaps) and descending data
+///argv = [name, numberOfElements, k]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../timsort_partial.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_SWAPS = 100;
+
+double measurePartialSort(std::vector<unsigned int> array, size_t k, const std::vector<unsigned int> &sortedArray)
+{
+    clock_t begin = clock();
+    std::partial_sort(array.begin(), array.begin() + k, array.end());
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    if (!std::equal(array.begin(), array.begin() + k, sortedArray.begin()))
+    {
+        throw "std::partial_sort result differs\n";
+    }
+    return time;
+}
+
+double measureTimSortPartial(std::vector<unsigned int> array, size_t k, const std::vector<unsigned int> &sortedArray)
+{
+    clock_t begin = clock();
+    timSortPartial(array.begin(), array.begin() + k, array.end());
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    if (!std::equal(array.begin(), array.begin() + k, sortedArray.begin()))
+    {
+        throw "timSortPartial result differs\n";
+    }
+    return time;
+}
+
+double measureTimSort(std::vector<unsigned int> array)
+{
+    clock_t begin = clock();
+    timSort(array.begin(), array.end());
+    return double(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+void compare(const char *distributionName, const std::vector<unsigned int> &array, size_t k)
+{
+    std::vector<unsigned int> sortedArray = array;
+    std::sort(sortedArray.begin(), sortedArray.end());
+    printf(
+           "%-14s partial_sort %8.3lf timSortPartial %8.3lf timSort %8.3lf\n", distributionName,
+           measurePartialSort(array, k, sortedArray), measureTimSortPartial(array, k, sortedArray), measureTimSort(array)
+          );
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 10000000u);
+    size_t k = std::min<size_t>(numberOfElements, (argc > 2 ? atoi(argv[2]) : 1000u));
+
+    std::vector<unsigned int> array(numberOfElements);
+    std::generate(array.begin(), array.end(), TimsortRand::generateUnsignedInt);
+
+    try
+    {
+        compare("random", array, k);
+
+        std::sort(array.begin(), array.end());
+        for (unsigned int i = 0; i < NUMBER_OF_SWAPS && numberOfElements > 0; ++i)
+        {
+            std::swap(array[TimsortRand::rand() % numberOfElements], array[TimsortRand::rand() % numberOfElements]);
+        }
+        compare("mostlySorted", array, k);
+
+        std::sort(array.begin(), array.end());
+        std::reverse(array.begin(), array.end());
+        compare("descending", array, k);
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+///Compares timSort, which allocates scratch memory from the default heap, with timSort, which takes it from
+///std::pmr::monotonic_buffer_resource over a preallocated arena, released after every sort (as a per-request arena would be)
+///Many arrays of the given size are sorted, so allocation cost is visible for small arrays; needs C++17
+///argv = [name, numberOfElements, numberOfArrays]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <vector>
+#include <algorithm>
+#include "../timsort.h"
+#include "../tests.h"
+
+
+std::vector<std::vector<int> > generateArrays(unsigned int numberOfElements, unsigned int numberOfArrays)
+{
+    std::vector<std::vector<int> > result(numberOfArrays, std::vector<int>(numberOfElements));
+    for (unsigned int i = 0; i < numberOfArrays; ++i)
+    {
+        std::generate(result[i].begin(), result[i].end(), TimsortRand::generateInt);
+    }
+    return result;
+}
+
+void checkSorted(const std::vector<std::vector<int> > &arrays)
+{
+    for (unsigned int i = 0; i < arrays.size(); ++i)
+    {
+        if (!std::is_sorted(arrays[i].begin(), arrays[i].end()))
+        {
+            throw "Array is not sorted\n";
+        }
+    }
+}
+
+double measureDefaultHeap(std::vector<std::vector<int> > arrays)
+{
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < arrays.size(); ++i)
+    {
+        timSort(arrays[i].begin(), arrays[i].end(), std::less<int>());
+    }
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    checkSorted(arrays);
+    return time;
+}
+
+double measureMonotonicArena(std::vector<std::vector<int> > arrays)
+{
+    ///buffer grows geometrically up to n elements, so all its allocations together take less than 2n elements, and stack of runs is small
+    std::vector<char> arena(4 * sizeof(int) * (arrays.empty() ? 0 : arrays[0].size()) + 4096);
+
+    clock_t begin = clock();
+    for (unsigned int i = 0; i < arrays.size(); ++i)
+    {
+        std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size());
+        timSort(arrays[i].begin(), arrays[i].end(), std::less<int>(), &resource);
+    }
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    checkSorted(arrays);
+    return time;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 1000u);
+    unsigned int numberOfArrays = (argc > 2 ? atoi(argv[2]) : 10000u);
+
+    try
+    {
+        std::vector<std::vector<int> > arrays = generateArrays(numberOfElements, numberOfArrays);
+        printf("default heap %8.3lf\n", measureDefaultHeap(arrays));
+        printf("monotonic_buffer_resource %8.3lf\n", measureMonotonicArena(arrays));
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+///Compares total merge cost (sum of sizes of merged runs, TimSortStats::mergedElements) of the default timSort policy and powersort
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include "../timsort.h"
+#include "../tests.h"
+
+
+///Concatenation of sorted runs, sizes of which are given by generateRunSize
+template<class GenerateRunSize>
+std::vector<int> generateRuns(unsigned int numberOfElements, GenerateRunSize generateRunSize)
+{
+    std::vector<int> result;
+    while (result.size() < numberOfElements)
+    {
+        unsigned int runSize = std::min<unsigned int>(generateRunSize(), numberOfElements - result.size());
+        std::vector<int> run(runSize);
+        std::generate(run.begin(), run.end(), TimsortRand::generateInt);
+        std::sort(run.begin(), run.end());
+        result.insert(result.end(), run.begin(), run.end());
+    }
+    return result;
+}
+
+///Run sizes 2^k, k is uniform in [5, 16], so there are a lot of short runs and a few long ones
+unsigned int generateGeometricRunSize()
+{
+    return 1u << (5u + TimsortRand::rand() % 12u);
+}
+
+///Long runs, each followed by a lot of short ones
+unsigned int generateLongAndShortRunSize()
+{
+    static unsigned int runNumber = 0;
+    return (runNumber++ % 64u == 0u ? 100000u : 40u);
+}
+
+///Run sizes grow and fall as a saw: 32, 64, ..., 32768, 32, 64, ...
+unsigned int generateSawtoothRunSize()
+{
+    static unsigned int runNumber = 0;
+    return 32u << (runNumber++ % 11u);
+}
+
+class MergeCostResult
+{
+public:
+    double mergeCostPerElement;
+
+    double time;
+};
+
+template<class Policy>
+MergeCostResult sortAndGetMergeCost(std::vector<int> arrayToSort)
+{
+    TimSortFunctionsAndClasses::TimSortStats stats;
+    clock_t begin = clock();
+    timSort<Policy>(arrayToSort.begin(), arrayToSort.end(), std::less<int>(), stats);
+    clock_t end = clock();
+
+    if (!std::is_sorted(arrayToSort.begin(), arrayToSort.end()))
+    {
+        throw "Array is not sorted\n";
+    }
+
+    MergeCostResult result = {1.0 * stats.mergedElements / arrayToSort.size(), double(end - begin) / CLOCKS_PER_SEC};
+    return result;
+}
+
+void compare(const char *distributionName, const std::vector<int> &arrayToSort)
+{
+    MergeCostResult timSortResult = sortAndGetMergeCost<TimSortFunctionsAndClasses::TimSortPolicyDefault>(arrayToSort);
+    MergeCostResult powersortResult = sortAndGetMergeCost<TimSortFunctionsAndClasses::TimSortPolicyPowersort>(arrayToSort);
+    printf(
+           "%-16s mergeCost/n: timSort %8.3lf powersort %8.3lf | time: timSort %8.3lf powersort %8.3lf\n",
+           distributionName,
+           timSortResult.mergeCostPerElement, powersortResult.mergeCostPerElement,
+           timSortResult.time, powersortResult.time
+          );
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 4000000u);
+
+    std::vector<int> randomArray(numberOfElements);
+    std::generate(randomArray.begin(), randomArray.end(), TimsortRand::generateInt);
+
+    compare("random", randomArray);
+    compare("equalRuns", TimsortRand::generatePartlySortedArray<int>(1000u, numberOfElements / 1000u));
+    compare("geometricRuns", generateRuns(numberOfElements, generateGeometricRunSize));
+    compare("longAndShortRuns", generateRuns(numberOfElements, generateLongAndShortRunSize));
+    compare("sawtoothRuns", generateRuns(numberOfElements, generateSawtoothRunSize));
+    return 0;
+}
@@ -0,0 +1,127 @@
+///Compares timSort and timSortStrings (LCP merges) on strings with long common prefixes (URLs, paths) and on short random strings
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "../timsort_strings.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_PARTS = 16;
+
+const unsigned int STRING_LENGTH = 16;
+
+const unsigned int LONG_URL_DEPTH = 8;
+
+const char * const URL_HOSTS[] = {"https://www.example.com/", "https://static.example.org/assets/", "http://api.example.net/v2/"};
+
+const char * const PATH_SEGMENTS[] = {"usr/", "lib/", "share/", "include/", "x86_64-linux-gnu/", "local/", "src/", "timsort/"};
+
+std::string generateUrl()
+{
+    std::string result = URL_HOSTS[TimsortRand::rand() % (sizeof(URL_HOSTS) / sizeof(URL_HOSTS[0]))];
+    result += "catalog/products/category-";
+    result += std::to_string(TimsortRand::rand() % 10);
+    result += "/item-";
+    result += std::to_string(TimsortRand::rand() % 100000);
+    return result;
+}
+
+///URL with a long path, which is mostly shared with other URLs
+std::string generateLongUrl()
+{
+    std::string result = URL_HOSTS[TimsortRand::rand() % (sizeof(URL_HOSTS) / sizeof(URL_HOSTS[0]))];
+    for (unsigned int i = 0; i < LONG_URL_DEPTH; ++i)
+    {
+        result += (TimsortRand::rand() % 8 == 0 ? "archive-of-older-catalog-entries/" : "catalog-of-products-and-services/");
+    }
+    result += std::to_string(TimsortRand::rand() % 100000);
+    return result;
+}
+
+std::string generatePath()
+{
+    std::string result = "/";
+    unsigned int depth = 6 + TimsortRand::rand() % 6;
+    for (unsigned int i = 0; i < depth; ++i)
+    {
+        result += PATH_SEGMENTS[TimsortRand::rand() % (sizeof(PATH_SEGMENTS) / sizeof(PATH_SEGMENTS[0]))];
+    }
+    result += std::to_string(TimsortRand::rand() % 1000);
+    return result;
+}
+
+std::string generateShortString()
+{
+    return TimsortRand::GenerateElement<std::string>(STRING_LENGTH)();
+}
+
+template<class Sort>
+double measure(std::vector<std::string> array, const std::vector<std::string> &sortedArray, Sort sort)
+{
+    clock_t begin = clock();
+    sort(array);
+    double time = double(clock() - begin) / CLOCKS_PER_SEC;
+    if (array != sortedArray)
+    {
+        throw "Array is not sorted\n";
+    }
+    return time;
+}
+
+void timSortVector(std::vector<std::string> &array)
+{
+    timSort(array.begin(), array.end());
+}
+
+void timSortStringsVector(std::vector<std::string> &array)
+{
+    timSortStrings(array.begin(), array.end());
+}
+
+void compare(const char *distributionName, const std::vector<std::string> &array)
+{
+    std::vector<std::string> sortedArray = array;
+    std::stable_sort(sortedArray.begin(), sortedArray.end());
+    printf(
+           "%-22s timSort %8.3lf timSortStrings %8.3lf\n", distributionName,
+           measure(array, sortedArray, timSortVector), measure(array, sortedArray, timSortStringsVector)
+          );
+}
+
+void compareRandomAndPartlySorted(const char *name, std::string (*generate)(), unsigned int numberOfElements)
+{
+    std::vector<std::string> array(numberOfElements);
+    std::generate(array.begin(), array.end(), generate);
+    compare((std::string(name) + " random").c_str(), array);
+
+    size_t partSize = std::max(1u, numberOfElements / NUMBER_OF_PARTS);
+    for (size_t begin = 0; begin < array.size(); begin += partSize)
+    {
+        std::sort(array.begin() + begin, array.begin() + std::min(begin + partSize, array.size()));
+    }
+    compare((std::string(name) + " partlySorted").c_str(), array);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 1000000u);
+
+    try
+    {
+        compareRandomAndPartlySorted("urls", generateUrl, numberOfElements);
+        compareRandomAndPartlySorted("longUrls", generateLongUrl, numberOfElements);
+        compareRandomAndPartlySorted("paths", generatePath, numberOfElements);
+        compareRandomAndPartlySorted("short", generateShortString, numberOfElements);
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
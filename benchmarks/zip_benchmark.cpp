@@ -0,0 +1,109 @@
+///Sorts 64-bit keys with 64-byte rows in a separate array by timSortZip and compares it with building pairs of keys and rows,
+///sorting them by timSort and copying them back to the arrays; random and partly sorted keys
+///argv = [name, numberOfElements]
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "../timsort_zip.h"
+#include "../tests.h"
+
+
+const unsigned int NUMBER_OF_PARTS = 16;
+
+class Row
+{
+public:
+    char payload[64];
+};
+
+class KeyOfPairComparator
+{
+public:
+    bool operator()(const std::pair<unsigned long long, Row> &first, const std::pair<unsigned long long, Row> &second) const
+    {
+        return first.first < second.first;
+    }
+};
+
+double sortPairs(std::vector<unsigned long long> &keys, std::vector<Row> &rows)
+{
+    clock_t begin = clock();
+    std::vector<std::pair<unsigned long long, Row> > pairs(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        pairs[i] = std::make_pair(keys[i], rows[i]);
+    }
+    timSort(pairs.begin(), pairs.end(), KeyOfPairComparator());
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = pairs[i].first;
+        rows[i] = pairs[i].second;
+    }
+    return double(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+double sortZip(std::vector<unsigned long long> &keys, std::vector<Row> &rows)
+{
+    clock_t begin = clock();
+    timSortZip(keys.begin(), keys.end(), rows.begin());
+    return double(clock() - begin) / CLOCKS_PER_SEC;
+}
+
+void compare(const char *distributionName, const std::vector<unsigned long long> &keys)
+{
+    std::vector<Row> rows(keys.size());
+    for (size_t i = 0; i < rows.size(); ++i)
+    {
+        memset(rows[i].payload, static_cast<int>(i), sizeof(rows[i].payload));
+    }
+
+    std::vector<unsigned long long> keysOfPairs = keys;
+    std::vector<Row> rowsOfPairs = rows;
+    double pairsTime = sortPairs(keysOfPairs, rowsOfPairs);
+
+    std::vector<unsigned long long> zippedKeys = keys;
+    std::vector<Row> zippedRows = rows;
+    double zipTime = sortZip(zippedKeys, zippedRows);
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        if (keysOfPairs[i] != zippedKeys[i] || memcmp(&rowsOfPairs[i], &zippedRows[i], sizeof(Row)) != 0)
+        {
+            throw "Results differ\n";
+        }
+    }
+    printf("%-14s pairs %8.3lf timSortZip %8.3lf\n", distributionName, pairsTime, zipTime);
+}
+
+int main(int argc, char **argv)
+{
+    unsigned int numberOfElements = (argc > 1 ? atoi(argv[1]) : 2000000u);
+
+    std::vector<unsigned long long> keys(numberOfElements);
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = static_cast<unsigned long long>(TimsortRand::generateUnsignedInt()) * TimsortRand::generateUnsignedInt();
+    }
+
+    try
+    {
+        compare("random", keys);
+        size_t partSize = std::max(1u, numberOfElements / NUMBER_OF_PARTS);
+        for (size_t begin = 0; begin < keys.size(); begin += partSize)
+        {
+            std::sort(keys.begin() + begin, keys.begin() + std::min(begin + partSize, keys.size()));
+        }
+        compare("partlySorted", keys);
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <algorithm>
 #include <vector>
 #include <string>
+#include <memory>
 
 namespace TimSortTestClasses
 {
@@ -60,6 +61,108 @@ namespace TimSortTestClasses
             return (a * b) > 0;
         }
     };
+    
+    ///Element, which counts how many times elements of its type were copied and moved
+    class MoveCountingElement
+    {
+    public:
+        static unsigned long long copiesCnt;
+        
+        static unsigned long long movesCnt;
+        
+        int value;
+        
+        MoveCountingElement() : value(0)
+        {
+        }
+        
+        explicit MoveCountingElement(int value) : value(value)
+        {
+        }
+        
+        MoveCountingElement(const MoveCountingElement &other) : value(other.value)
+        {
+            ++copiesCnt;
+        }
+        
+        MoveCountingElement(MoveCountingElement &&other) : value(other.value)
+        {
+            ++movesCnt;
+        }
+        
+        MoveCountingElement &operator=(const MoveCountingElement &other)
+        {
+            ++copiesCnt;
+            value = other.value;
+            return *this;
+        }
+        
+        MoveCountingElement &operator=(MoveCountingElement &&other)
+        {
+            ++movesCnt;
+            value = other.value;
+            return *this;
+        }
+        
+        bool operator<(const MoveCountingElement &other) const
+        {
+            return value < other.value;
+        }
+        
+        static void resetCounters()
+        {
+            copiesCnt = 0;
+            movesCnt = 0;
+        }
+    };
+    
+    unsigned long long MoveCountingElement::copiesCnt = 0;
+    
+    unsigned long long MoveCountingElement::movesCnt = 0;
+    
+    ///Element, which can be moved, but not copied, so a copy anywhere in sort doesn't compile
+    class MoveOnlyElement
+    {
+    public:
+        std::unique_ptr<int> value;
+        
+        MoveOnlyElement()
+        {
+        }
+        
+        explicit MoveOnlyElement(int value) : value(new int(value))
+        {
+        }
+        
+        bool operator<(const MoveOnlyElement &other) const
+        {
+            return *value < *other.value;
+        }
+    };
+    
+    ///Returns a copy of element; elements, which can't be copied, are built anew
+    template<class ElementType>
+    ElementType cloneElement(const ElementType &element)
+    {
+        return element;
+    }
+    
+    inline MoveOnlyElement cloneElement(const MoveOnlyElement &element)
+    {
+        return MoveOnlyElement(*element.value);
+    }
+    
+    template<class ElementType>
+    std::vector<ElementType> cloneArray(const std::vector<ElementType> &array)
+    {
+        std::vector<ElementType> result;
+        result.reserve(array.size());
+        for (size_t i = 0; i < array.size(); ++i)
+        {
+            result.push_back(cloneElement(array[i]));
+        }
+        return result;
+    }
 };
 
 
@@ -111,7 +214,7 @@ namespace TimsortRand
     class GenerateElement<int>
     {    
     public:
-        GenerateElement(unsigned int additionalParameter=0u) 
+        GenerateElement(unsigned int = 0u)
         {
         }
         
@@ -125,7 +228,7 @@ namespace TimsortRand
     class GenerateElement<std::pair<unsigned int, int> >
     {    
     public:
-        GenerateElement(unsigned int additionalParameter=0u) 
+        GenerateElement(unsigned int = 0u)
         {
         }
         
@@ -165,7 +268,7 @@ namespace TimsortRand
     class GenerateElement<TimSortTestClasses::Point>
     {    
     public:
-        GenerateElement(unsigned int additionalParameter=0u) 
+        GenerateElement(unsigned int = 0u)
         {
         }
         
@@ -176,6 +279,38 @@ namespace TimsortRand
     };
     
     
+    template<>
+    class GenerateElement<TimSortTestClasses::MoveCountingElement>
+    {    
+    public:
+        GenerateElement(unsigned int = 0u)
+        {
+        }
+        
+        TimSortTestClasses::MoveCountingElement operator()() const
+        {
+            static const int MAX_VALUE = 1000; ///made to have equal elements
+            return TimSortTestClasses::MoveCountingElement(generateUnsignedInt() % MAX_VALUE);
+        }
+    };
+    
+    
+    template<>
+    class GenerateElement<TimSortTestClasses::MoveOnlyElement>
+    {    
+    public:
+        GenerateElement(unsigned int = 0u)
+        {
+        }
+        
+        TimSortTestClasses::MoveOnlyElement operator()() const
+        {
+            static const int MAX_VALUE = 1000; ///made to have equal elements
+            return TimSortTestClasses::MoveOnlyElement(generateUnsignedInt() % MAX_VALUE);
+        }
+    };
+    
+    
     template<class ElementType, class Compare=std::less<ElementType> >
     std::vector <ElementType> generatePartlySortedArray(unsigned int lengthOfEach, unsigned int numberOfParts, unsigned int additionalParameter=0u, Compare comp = Compare())
     {
@@ -186,7 +321,7 @@ namespace TimsortRand
             std::vector <ElementType> temporaryArray(lengthOfEach);
             std::generate(temporaryArray.begin(), temporaryArray.end(), GenerateElement<ElementType>(additionalParameter));
             std::stable_sort(temporaryArray.begin(), temporaryArray.end(), comp);
-            std::copy(temporaryArray.begin(), temporaryArray.end(), result.begin() + i * lengthOfEach);
+            std::move(temporaryArray.begin(), temporaryArray.end(), result.begin() + i * lengthOfEach);
         }
         
         return result;
@@ -1,11 +1,74 @@
 #include <ctime>
 #include <cstdio>
+#include <cstddef>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <string>
 #include <vector>
+#include <deque>
 #include <iostream>
 #include <algorithm>
 #include "timsort.h"
+#include "timsort_parallel.h"
+#include "timsort_external.h"
+#include "timsort_incremental.h"
+#include "timsort_by_key.h"
+#include "timsort_hybrid.h"
+#include "timsort_zip.h"
+#include "timsort_strings.h"
+#include "timsort_partial.h"
 #include "tests.h"
 
+
+///All allocations of the driver are counted, so tests can check peak memory usage
+namespace AllocatedMemory
+{
+    std::atomic<size_t> current(0);
+    
+    std::atomic<size_t> peak(0);
+    
+    ///Peak usage is measured from now on
+    void resetPeak()
+    {
+        peak = current.load();
+    }
+};
+
+///Compilers, which inline operator new and delete into their callers, warn about pointer arithmetic and free on the result of new
+#ifdef __GNUC__
+#define _NOT_INLINED __attribute__((noinline))
+#else
+#define _NOT_INLINED
+#endif
+
+///Size of block is stored before it; max_align_t keeps alignment of the block
+_NOT_INLINED void *operator new(size_t size)
+{
+    char *block = static_cast<char*>(std::malloc(size + sizeof(std::max_align_t)));
+    if (!block)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<size_t*>(block) = size;
+    size_t current = (AllocatedMemory::current += size);
+    size_t peak = AllocatedMemory::peak.load();
+    while (current > peak && !AllocatedMemory::peak.compare_exchange_weak(peak, current))
+    {
+    }
+    return block + sizeof(std::max_align_t);
+}
+
+_NOT_INLINED void operator delete(void *pointer) noexcept
+{
+    if (pointer)
+    {
+        char *block = static_cast<char*>(pointer) - sizeof(std::max_align_t);
+        AllocatedMemory::current -= *reinterpret_cast<size_t*>(block);
+        std::free(block);
+    }
+}
+
 namespace TimSortFunctionsAndClasses
 {
     class TimSortParametersTwo : public TimSortParametersDefault
@@ -13,12 +76,12 @@ namespace TimSortFunctionsAndClasses
     public:
         static TimSortParametersTwo TimSortParametersTwoObject;
         
-        MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY, unsigned int sizeOfZ) const
+        MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY, size_t) const
         {
             return getMergeAction(sizeOfX, sizeOfY);
         }
         
-        MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY) const
+        MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY) const
         {
             if (sizeOfY <= sizeOfX)
             {
@@ -32,6 +95,28 @@ namespace TimSortFunctionsAndClasses
     };
     
     TimSortParametersTwo TimSortParametersTwo::TimSortParametersTwoObject = TimSortParametersTwo();
+    
+    ///The same as TimSortParametersTwo, but for timSort<TimSortPolicyTwo>, so it is inlined
+    class TimSortPolicyTwo : public TimSortPolicyDefault
+    {
+    public:
+        static MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY, size_t)
+        {
+            return getMergeAction(sizeOfX, sizeOfY);
+        }
+        
+        static MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY)
+        {
+            if (sizeOfY <= sizeOfX)
+            {
+                return MERGE_YX;
+            }
+            else
+            {
+                return MERGE_NOTHING;
+            }
+        }
+    };
 };
 
 
@@ -109,12 +194,50 @@ double sortAndGetTime(
     return double(end - begin) / CLOCKS_PER_SEC;
 }
 
+///Prints number of copies and moves, made by sort, for the element types which count them
+template <class ElementsType>
+class CopiesAndMovesReporter
+{
+public:
+    static void reset()
+    {
+    }
+    
+    ///Other element types don't count copies and moves, so there is nothing to report
+    static void report(const char *)
+    {
+    }
+};
+
+template <>
+class CopiesAndMovesReporter<TimSortTestClasses::MoveCountingElement>
+{
+public:
+    static void reset()
+    {
+        TimSortTestClasses::MoveCountingElement::resetCounters();
+    }
+    
+    static void report(const char *sortName)
+    {
+        printf(
+               "%-24s copies: %llu moves: %llu\n", sortName,
+               TimSortTestClasses::MoveCountingElement::copiesCnt,
+               TimSortTestClasses::MoveCountingElement::movesCnt
+              );
+    }
+};
+
 template <class ElementsType, class Compare = std::less<ElementsType> >
 void proceedTest(std::vector<ElementsType> arrayToSort, unsigned int numberOfTest, Compare comp = Compare())
 {
-    std::vector<ElementsType> arrayToSortCopy = arrayToSort;
+    std::vector<ElementsType> arrayToSortCopy = TimSortTestClasses::cloneArray(arrayToSort);
+    CopiesAndMovesReporter<ElementsType>::reset();
     double stdStableSortTime = sortAndGetTime(arrayToSortCopy, &std::stable_sort, comp);
+    CopiesAndMovesReporter<ElementsType>::report("std::stable_sort");
+    CopiesAndMovesReporter<ElementsType>::reset();
     double timSortTime = sortAndGetTime(arrayToSort, &timSort, comp);
+    CopiesAndMovesReporter<ElementsType>::report("timSort");
     
     if (areEqual(arrayToSort, arrayToSortCopy, comp))
     {
@@ -147,7 +270,7 @@ void test(TestParameters currentParameters, Compare comp)
 template<class ElementsType, class SpecialCompare = std::less<ElementsType>, class Compare = std::less<ElementsType> >
 void chooseComparatorAndTest(TestParameters currentParameters, SpecialCompare specialComp = SpecialCompare(), Compare comp = Compare())
 {
-    bool useSpecialComparator = (currentParameters.argc == currentParameters.argumentsShift);
+    bool useSpecialComparator = (static_cast<unsigned int>(currentParameters.argc) == currentParameters.argumentsShift);
     
     if (useSpecialComparator)
     {
@@ -160,6 +283,913 @@ void chooseComparatorAndTest(TestParameters currentParameters, SpecialCompare sp
 }
 
 
+///Prints the result of a test of a feature, which is not a plain timSort call
+void reportFeatureTest(bool isCorrect, unsigned int numberOfTest, const char *description)
+{
+    if (isCorrect)
+    {
+        printf("OK TEST %u\n", numberOfTest);
+    }
+    else
+    {
+        printf("WRONG %s\n", description);
+    }
+}
+
+///Sorts copy of array by sort and compares it with the result of std::stable_sort; elements shall be equal, not only equivalent
+template<class ElementsType, class Compare, class Sort>
+bool isSortedAsStableSort(std::vector<ElementsType> array, Compare comp, Sort sort)
+{
+    std::vector<ElementsType> expected = array;
+    std::stable_sort(expected.begin(), expected.end(), comp);
+    sort(array);
+    return array == expected;
+}
+
+///parallelTimSort of pairs with few distinct keys, compared by keys only, so unstable result differs from std::stable_sort
+///Random and partly sorted arrays of length elements and arrays shorter than the number of threads are sorted with different
+///numbers of threads and thresholds of parallel merge (threshold 1 splits every merge between threads)
+void testParallelTimSort(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    const unsigned int NUMBERS_OF_THREADS[] = {1u, 2u, 3u, 4u, 8u};
+    const size_t PARALLEL_MERGE_THRESHOLDS[] = {1u, 1000u, TimSortFunctionsAndClasses::DEFAULT_PARALLEL_MERGE_THRESHOLD};
+    const unsigned int NUMBER_OF_PARTS = 16u;
+    const unsigned int MAX_SHORT_LENGTH = 20u;
+    
+    std::vector<std::vector<ElementType> > arrays;
+    arrays.push_back(TimsortRand::generatePartlySortedArray<ElementType>(1u, length, 0u, SpecialPairComparator()));
+    arrays.push_back(TimsortRand::generatePartlySortedArray<ElementType>(length / NUMBER_OF_PARTS, NUMBER_OF_PARTS, 0u, SpecialPairComparator()));
+    for (unsigned int shortLength = 0; shortLength <= MAX_SHORT_LENGTH; ++shortLength)
+    {
+        arrays.push_back(TimsortRand::generatePartlySortedArray<ElementType>(1u, shortLength, 0u, SpecialPairComparator()));
+    }
+    
+    TimSortFunctionsAndClasses::TimSortParametersDefault parameters;
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        for (size_t indexOfThreads = 0; indexOfThreads < sizeof(NUMBERS_OF_THREADS) / sizeof(NUMBERS_OF_THREADS[0]); ++indexOfThreads)
+        {
+            for (size_t indexOfThreshold = 0; indexOfThreshold < sizeof(PARALLEL_MERGE_THRESHOLDS) / sizeof(PARALLEL_MERGE_THRESHOLDS[0]); ++indexOfThreshold)
+            {
+                unsigned int numberOfThreads = NUMBERS_OF_THREADS[indexOfThreads];
+                size_t parallelMergeThreshold = PARALLEL_MERGE_THRESHOLDS[indexOfThreshold];
+                isCorrect &= isSortedAsStableSort(
+                                                  arrays[indexOfArray], SpecialPairComparator(),
+                                                  [&](std::vector<ElementType> &array)
+                                                  {
+                                                      parallelTimSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(
+                                                                                                                         array.begin(), array.end(), SpecialPairComparator(),
+                                                                                                                         numberOfThreads, parallelMergeThreshold
+                                                                                                                        );
+                                                  }
+                                                 );
+            }
+        }
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [&](std::vector<ElementType> &array)
+                                          {
+                                              parallelTimSort(array.begin(), array.end(), &parameters, SpecialPairComparator(), 4u);
+                                          }
+                                         );
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "parallelTimSort differs from std::stable_sort");
+}
+
+///Trivially copyable record for externalTimSort; index is its position in the input file
+class ExternalRecord
+{
+public:
+    unsigned int key;
+    
+    unsigned int index;
+    
+    bool operator==(const ExternalRecord &other) const
+    {
+        return key == other.key && index == other.index;
+    }
+};
+
+class ExternalRecordComparator
+{
+public:
+    bool operator()(const ExternalRecord &first, const ExternalRecord &second) const
+    {
+        return first.key < second.key;
+    }
+};
+
+///Memory for file names and other small allocations of externalTimSort, which are not limited
+const size_t EXTERNAL_SORT_MEMORY_SLACK_IN_BYTES = 1u << 16;
+
+///externalTimSort of numberOfRecords records with few distinct keys and memory limit of memoryInKilobytes (at least MIN_EXTERNAL_BUFFER_SIZE_IN_BYTES)
+///Result is compared with std::stable_sort; memory, allocated during sort, shall not exceed the limit
+void testExternalTimSort(unsigned int numberOfTest, unsigned int numberOfRecords, unsigned int memoryInKilobytes)
+{
+    const unsigned int NUMBER_OF_KEYS = 1000u;
+    const std::string inputFileName = "timsort_external_test" + std::to_string(numberOfTest) + ".in";
+    const std::string outputFileName = "timsort_external_test" + std::to_string(numberOfTest) + ".out";
+    size_t memoryLimitInBytes = std::max<size_t>(static_cast<size_t>(memoryInKilobytes) << 10, TimSortFunctionsAndClasses::MIN_EXTERNAL_BUFFER_SIZE_IN_BYTES);
+    
+    std::vector<ExternalRecord> expected(numberOfRecords);
+    for (unsigned int i = 0; i < numberOfRecords; ++i)
+    {
+        expected[i].key = TimsortRand::generateUnsignedInt() % NUMBER_OF_KEYS;
+        expected[i].index = i;
+    }
+    std::FILE *input = TimSortFunctionsAndClasses::openFile(inputFileName, "wb");
+    std::fwrite(expected.data(), sizeof(ExternalRecord), expected.size(), input);
+    std::fclose(input);
+    std::stable_sort(expected.begin(), expected.end(), ExternalRecordComparator());
+    
+    size_t memoryBeforeSort = AllocatedMemory::current.load();
+    AllocatedMemory::resetPeak();
+    externalTimSort<ExternalRecord>(inputFileName, outputFileName, memoryLimitInBytes, ExternalRecordComparator());
+    size_t memoryOfSort = AllocatedMemory::peak.load() - memoryBeforeSort;
+    
+    std::vector<ExternalRecord> result(numberOfRecords + 1);
+    std::FILE *output = TimSortFunctionsAndClasses::openFile(outputFileName, "rb");
+    result.resize(std::fread(result.data(), sizeof(ExternalRecord), result.size(), output));
+    std::fclose(output);
+    std::remove(inputFileName.c_str());
+    std::remove(outputFileName.c_str());
+    
+    if (result != expected)
+    {
+        reportFeatureTest(false, numberOfTest, "externalTimSort differs from std::stable_sort");
+        return;
+    }
+    printf("memory limit %zu bytes, allocated %zu bytes\n", memoryLimitInBytes, memoryOfSort);
+    reportFeatureTest(memoryOfSort <= memoryLimitInBytes + EXTERNAL_SORT_MEMORY_SLACK_IN_BYTES, numberOfTest, "externalTimSort exceeds memory limit");
+}
+
+///Throws, when the number of comparisons, counted in *numberOfComparisons, reaches numberOfComparisonsToThrow
+class ThrowingExternalRecordComparator
+{
+    size_t *numberOfComparisons;
+    
+    size_t numberOfComparisonsToThrow;
+public:
+    ThrowingExternalRecordComparator(size_t *numberOfComparisons, size_t numberOfComparisonsToThrow) :
+        numberOfComparisons(numberOfComparisons), numberOfComparisonsToThrow(numberOfComparisonsToThrow)
+    {
+    }
+    
+    bool operator()(const ExternalRecord &first, const ExternalRecord &second) const
+    {
+        if (++*numberOfComparisons == numberOfComparisonsToThrow)
+        {
+            throw "Comparator failed\n";
+        }
+        return first.key < second.key;
+    }
+};
+
+bool doesFileExist(const std::string &fileName)
+{
+    std::FILE *file = std::fopen(fileName.c_str(), "rb");
+    if (file)
+    {
+        std::fclose(file);
+    }
+    return file != 0;
+}
+
+///externalTimSort, comparator of which throws at different moments of chunk sorts and merges; temporary files shall be removed
+///Temporary files are looked for among the first MAX_NUMBER_OF_RUN_FILES run files of the first MAX_NUMBER_OF_PASSES passes
+void testExternalTimSortFailure(unsigned int numberOfTest, unsigned int numberOfRecords, unsigned int memoryInKilobytes)
+{
+    const unsigned int NUMBER_OF_KEYS = 1000u;
+    const unsigned int NUMBER_OF_FAILURES = 8u;
+    const unsigned int MAX_NUMBER_OF_RUN_FILES = 64u;
+    const unsigned int MAX_NUMBER_OF_PASSES = 8u;
+    const std::string inputFileName = "timsort_external_test" + std::to_string(numberOfTest) + ".in";
+    const std::string outputFileName = "timsort_external_test" + std::to_string(numberOfTest) + ".out";
+    const std::string temporaryFilesPrefix = "timsort_external_test" + std::to_string(numberOfTest) + ".run";
+    size_t memoryLimitInBytes = static_cast<size_t>(memoryInKilobytes) << 10;
+    
+    std::vector<ExternalRecord> records(numberOfRecords);
+    for (unsigned int i = 0; i < numberOfRecords; ++i)
+    {
+        records[i].key = TimsortRand::generateUnsignedInt() % NUMBER_OF_KEYS;
+        records[i].index = i;
+    }
+    std::FILE *input = TimSortFunctionsAndClasses::openFile(inputFileName, "wb");
+    std::fwrite(records.data(), sizeof(ExternalRecord), records.size(), input);
+    std::fclose(input);
+    
+    size_t numberOfComparisons = 0;
+    externalTimSort<ExternalRecord>(
+                                    inputFileName, outputFileName, memoryLimitInBytes,
+                                    ThrowingExternalRecordComparator(&numberOfComparisons, 0u), temporaryFilesPrefix
+                                   );
+    size_t numberOfComparisonsOfSort = numberOfComparisons;
+    
+    bool isCorrect = true;
+    for (unsigned int failure = 1; failure <= NUMBER_OF_FAILURES; ++failure)
+    {
+        numberOfComparisons = 0;
+        bool hasThrown = false;
+        try
+        {
+            externalTimSort<ExternalRecord>(
+                                            inputFileName, outputFileName, memoryLimitInBytes,
+                                            ThrowingExternalRecordComparator(&numberOfComparisons, numberOfComparisonsOfSort * failure / (NUMBER_OF_FAILURES + 1)),
+                                            temporaryFilesPrefix
+                                           );
+        }
+        catch (const char *)
+        {
+            hasThrown = true;
+        }
+        isCorrect &= hasThrown;
+        for (unsigned int indexOfFile = 0; indexOfFile < MAX_NUMBER_OF_RUN_FILES; ++indexOfFile)
+        {
+            isCorrect &= !doesFileExist(temporaryFilesPrefix + std::to_string(indexOfFile));
+            for (unsigned int pass = 0; pass < MAX_NUMBER_OF_PASSES; ++pass)
+            {
+                isCorrect &= !doesFileExist(temporaryFilesPrefix + std::to_string(pass) + "." + std::to_string(indexOfFile));
+            }
+        }
+    }
+    std::remove(inputFileName.c_str());
+    std::remove(outputFileName.c_str());
+    reportFeatureTest(isCorrect, numberOfTest, "externalTimSort leaves temporary files after exception");
+}
+
+///Pushes elements [begin, end) of array into sorter by batches of batchSize elements (random sizes up to 2 * batchSize, including empty ones,
+///if batchSize is 0), alternating overloads of push
+const size_t DEFAULT_RANDOM_BATCH_SIZE = 100u;
+
+template<class Sorter>
+void pushByBatches(Sorter &sorter, const std::vector<std::pair<unsigned int, int> > &array, size_t begin, size_t end, size_t batchSize)
+{
+    for (size_t indexOfBatch = 0; begin < end; ++indexOfBatch)
+    {
+        size_t size = (batchSize ? batchSize : TimsortRand::generateUnsignedInt() % (2 * DEFAULT_RANDOM_BATCH_SIZE + 1));
+        size_t batchEnd = std::min(end, begin + size);
+        std::vector<std::pair<unsigned int, int> > batch(array.begin() + begin, array.begin() + batchEnd);
+        switch (indexOfBatch % 3)
+        {
+            case 0:
+                sorter.push(batch.begin(), batch.end());
+                break;
+            case 1:
+                sorter.push(batch);
+                break;
+            default:
+                sorter.push(std::move(batch));
+                break;
+        }
+        begin = batchEnd;
+    }
+}
+
+///Array of length elements, which consists of natural runs of runLength elements with keys less than numberOfKeys (ascending or descending),
+///the second element of pair is its index
+std::vector<std::pair<unsigned int, int> > generateRunsOfPairs(size_t length, size_t runLength, unsigned int numberOfKeys, bool areRunsDescending)
+{
+    std::vector<std::pair<unsigned int, int> > result(length);
+    for (size_t i = 0; i < length; ++i)
+    {
+        result[i].first = TimsortRand::generateUnsignedInt() % numberOfKeys;
+    }
+    for (size_t begin = 0; begin < length; begin += runLength)
+    {
+        std::vector<std::pair<unsigned int, int> >::iterator end = result.begin() + std::min(length, begin + runLength);
+        std::sort(result.begin() + begin, end, SpecialPairComparator());
+        if (areRunsDescending)
+        {
+            std::reverse(result.begin() + begin, end);
+        }
+    }
+    for (size_t i = 0; i < length; ++i)
+    {
+        result[i].second = static_cast<int>(i);
+    }
+    return result;
+}
+
+///IncrementalTimSorter of pairs, compared by keys, with batches of batchSize elements, one element and random sizes
+///Natural runs are longer than batches, so batch boundaries fall inside ascending and descending runs, and equal keys cross batches;
+///then pushes and finish calls are interleaved: every finish shall return the elements, pushed after the previous one, as std::stable_sort
+void testIncrementalTimSorter(unsigned int numberOfTest, unsigned int length, unsigned int batchSize)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    typedef IncrementalTimSorter<ElementType, SpecialPairComparator> Sorter;
+    const unsigned int NUMBERS_OF_KEYS[] = {10u, 1000000u};
+    const size_t BATCH_SIZES[] = {batchSize, 1u, 0u};
+    const size_t NUMBER_OF_FINISHES = 5u;
+    
+    bool isCorrect = true;
+    for (size_t indexOfKeys = 0; indexOfKeys < sizeof(NUMBERS_OF_KEYS) / sizeof(NUMBERS_OF_KEYS[0]); ++indexOfKeys)
+    {
+        for (int areRunsDescending = 0; areRunsDescending < 2; ++areRunsDescending)
+        {
+            std::vector<ElementType> array = generateRunsOfPairs(length, 5u * batchSize / 2u + 1u, NUMBERS_OF_KEYS[indexOfKeys], areRunsDescending);
+            for (size_t indexOfBatchSize = 0; indexOfBatchSize < sizeof(BATCH_SIZES) / sizeof(BATCH_SIZES[0]); ++indexOfBatchSize)
+            {
+                isCorrect &= isSortedAsStableSort(
+                                                  array, SpecialPairComparator(),
+                                                  [&](std::vector<ElementType> &arrayToSort)
+                                                  {
+                                                      Sorter sorter(indexOfBatchSize == 0 ? arrayToSort.size() : 0u);
+                                                      pushByBatches(sorter, arrayToSort, 0, arrayToSort.size(), BATCH_SIZES[indexOfBatchSize]);
+                                                      arrayToSort = sorter.finish();
+                                                  }
+                                                 );
+            }
+            
+            Sorter sorter;
+            for (size_t indexOfFinish = 0; indexOfFinish < NUMBER_OF_FINISHES; ++indexOfFinish)
+            {
+                size_t begin = length * indexOfFinish / NUMBER_OF_FINISHES;
+                size_t end = length * (indexOfFinish + 1) / NUMBER_OF_FINISHES;
+                std::vector<ElementType> expected(array.begin() + begin, array.begin() + end);
+                std::stable_sort(expected.begin(), expected.end(), SpecialPairComparator());
+                pushByBatches(sorter, array, begin, end, batchSize);
+                isCorrect &= (sorter.size() == end - begin);
+                isCorrect &= (sorter.finish() == expected);
+            }
+            isCorrect &= sorter.finish().empty();
+        }
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "IncrementalTimSorter differs from std::stable_sort");
+}
+
+///timSort with TimSortPolicyPowersort of pairs with few distinct keys, compared by keys only: random arrays, arrays of sorted parts
+///and arrays of ascending or descending runs of different lengths, so runs are merged in different orders than by the default policy
+void testPowersort(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    const unsigned int NUMBERS_OF_KEYS[] = {2u, 10u, 1000u};
+    const size_t RUN_LENGTHS[] = {3u, 40u, 1000u};
+    
+    std::vector<std::vector<ElementType> > arrays;
+    arrays.push_back(std::vector<ElementType>(length));
+    std::generate(arrays.back().begin(), arrays.back().end(), TimsortRand::GenerateElement<ElementType>());
+    arrays.push_back(TimsortRand::generatePartlySortedArray<ElementType>(length / 16u + 1u, 16u, 0u, SpecialPairComparator()));
+    for (size_t indexOfKeys = 0; indexOfKeys < sizeof(NUMBERS_OF_KEYS) / sizeof(NUMBERS_OF_KEYS[0]); ++indexOfKeys)
+    {
+        for (size_t indexOfRunLength = 0; indexOfRunLength < sizeof(RUN_LENGTHS) / sizeof(RUN_LENGTHS[0]); ++indexOfRunLength)
+        {
+            for (int areRunsDescending = 0; areRunsDescending < 2; ++areRunsDescending)
+            {
+                arrays.push_back(generateRunsOfPairs(length, RUN_LENGTHS[indexOfRunLength] + indexOfKeys, NUMBERS_OF_KEYS[indexOfKeys], areRunsDescending));
+            }
+        }
+    }
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [](std::vector<ElementType> &array)
+                                          {
+                                              timSort<TimSortFunctionsAndClasses::TimSortPolicyPowersort>(array.begin(), array.end(), SpecialPairComparator());
+                                          }
+                                         );
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSort with TimSortPolicyPowersort differs from std::stable_sort");
+}
+
+///Arrays of length pairs with few distinct keys (the second elements tell equal keys apart): random one, one of sorted parts,
+///one of long ascending runs with two keys and one of short descending runs, so equal keys meet in run detection and in merges
+std::vector<std::vector<std::pair<unsigned int, int> > > generateArraysWithEqualKeys(unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    std::vector<std::vector<ElementType> > arrays;
+    arrays.push_back(std::vector<ElementType>(length));
+    std::generate(arrays.back().begin(), arrays.back().end(), TimsortRand::GenerateElement<ElementType>());
+    arrays.push_back(TimsortRand::generatePartlySortedArray<ElementType>(length / 16u + 1u, 16u, 0u, SpecialPairComparator()));
+    arrays.push_back(generateRunsOfPairs(length, length / 5u + 1u, 2u, false));
+    arrays.push_back(generateRunsOfPairs(length, 100u, 1000u, true));
+    return arrays;
+}
+
+///timSort of pairs with few distinct keys, compared by keys only, with merge buffer limited by setMaxBufferBytes (down to 1 byte, i.e. one element),
+///so merges are split by rotations, and their results shall stay as std::stable_sort; peakBufferBytes shall stay within the limit
+void testBoundedMemoryTimSort(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    typedef TimSortFunctionsAndClasses::TimSortWorkspace<std::vector<ElementType>::iterator, TimSortFunctionsAndClasses::TimSortStats> Workspace;
+    const size_t MAX_BUFFER_BYTES[] = {1u, 3u * sizeof(ElementType), 1u << 10, 1u << 16};
+    
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        for (size_t indexOfLimit = 0; indexOfLimit < sizeof(MAX_BUFFER_BYTES) / sizeof(MAX_BUFFER_BYTES[0]); ++indexOfLimit)
+        {
+            size_t maxBufferBytes = MAX_BUFFER_BYTES[indexOfLimit];
+            isCorrect &= isSortedAsStableSort(
+                                              arrays[indexOfArray], SpecialPairComparator(),
+                                              [&](std::vector<ElementType> &array)
+                                              {
+                                                  Workspace workspace;
+                                                  workspace.setMaxBufferBytes(maxBufferBytes);
+                                                  timSort(array.begin(), array.end(), SpecialPairComparator(), workspace);
+                                                  isCorrect &= (workspace.getStats().peakBufferBytes <= std::max(maxBufferBytes, sizeof(ElementType)));
+                                              }
+                                             );
+        }
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSort with limited merge buffer differs from std::stable_sort or exceeds the limit");
+}
+
+///Whether stats are as after reset: nothing was compared, moved or merged
+bool areStatsEmpty(const TimSortFunctionsAndClasses::TimSortStats &stats)
+{
+    return stats.comparisons == 0 && stats.moves == 0 && stats.naturalRuns == 0 && stats.naturalRunLengthHistogram.empty() &&
+           stats.merges == 0 && stats.mergedElements == 0 && stats.peakBufferBytes == 0;
+}
+
+///Statistics of timSort are reset at the beginning of each call: an empty range, sorted with the stats of a previous non-empty sort,
+///leaves them empty both for contiguous ranges (sorted by pointers) and for other ones
+void testTimSortStatsOfEmptyRange(unsigned int numberOfTest, unsigned int length)
+{
+    std::vector<int> array(length);
+    std::generate(array.begin(), array.end(), TimsortRand::GenerateElement<int>());
+    std::deque<int> deque(array.begin(), array.end());
+    TimSortFunctionsAndClasses::TimSortStats stats;
+    
+    bool isCorrect = true;
+    timSort(array.begin(), array.end(), std::less<int>(), stats);
+    isCorrect &= (length < 2 || stats.comparisons > 0);
+    timSort(array.end(), array.end(), std::less<int>(), stats);
+    isCorrect &= areStatsEmpty(stats);
+    
+    timSort(deque.begin(), deque.end(), std::less<int>(), stats);
+    isCorrect &= (length < 2 || stats.comparisons > 0);
+    timSort(deque.end(), deque.end(), std::less<int>(), stats);
+    isCorrect &= areStatsEmpty(stats);
+    reportFeatureTest(isCorrect, numberOfTest, "TimSortStats are not reset by sort of empty range");
+}
+
+///Key of pair, which counts its calls
+class CountingKeyOfPair
+{
+    size_t *counter;
+public:
+    explicit CountingKeyOfPair(size_t *counter) : counter(counter)
+    {
+    }
+    
+    unsigned int operator()(const std::pair<unsigned int, int> &element) const
+    {
+        ++*counter;
+        return element.first;
+    }
+};
+
+///timSortByKey of pairs by their first elements in ascending and descending order, compared with std::stable_sort;
+///the key function shall be called exactly once for each element
+void testTimSortByKey(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [&](std::vector<ElementType> &array)
+                                          {
+                                              size_t numberOfKeys = 0;
+                                              timSortByKey(array.begin(), array.end(), CountingKeyOfPair(&numberOfKeys));
+                                              isCorrect &= (numberOfKeys == array.size());
+                                          }
+                                         );
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray],
+                                          [](const ElementType &first, const ElementType &second)
+                                          {
+                                              return first.first > second.first;
+                                          },
+                                          [&](std::vector<ElementType> &array)
+                                          {
+                                              size_t numberOfKeys = 0;
+                                              timSortByKey(array.begin(), array.end(), CountingKeyOfPair(&numberOfKeys), std::greater<unsigned int>());
+                                              isCorrect &= (numberOfKeys == array.size());
+                                          }
+                                         );
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSortByKey differs from std::stable_sort or extracts keys more than once");
+}
+
+///Whether sorting array with timSortIndices<IndexType> gives the permutation of std::stable_sort, both when elements are taken
+///by indices and when array is reordered by applyPermutation
+template<class IndexType>
+bool isSortedByIndicesAsStableSort(const std::vector<std::pair<unsigned int, int> > &array)
+{
+    std::vector<std::pair<unsigned int, int> > expected = array;
+    std::stable_sort(expected.begin(), expected.end(), SpecialPairComparator());
+    std::vector<IndexType> permutation = timSortIndices<IndexType>(array.begin(), array.end(), SpecialPairComparator());
+    
+    bool isCorrect = (permutation.size() == array.size());
+    for (size_t i = 0; isCorrect && i < permutation.size(); ++i)
+    {
+        isCorrect &= (array[permutation[i]] == expected[i]);
+    }
+    std::vector<std::pair<unsigned int, int> > permuted = array;
+    applyPermutation(permuted.begin(), permuted.end(), permutation);
+    return isCorrect && permuted == expected;
+}
+
+///timSortIndices with 32-bit and 64-bit indices and applyPermutation on pairs with equal keys, compared with std::stable_sort
+void testTimSortIndices(unsigned int numberOfTest, unsigned int length)
+{
+    std::vector<std::vector<std::pair<unsigned int, int> > > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        isCorrect &= isSortedByIndicesAsStableSort<unsigned int>(arrays[indexOfArray]);
+        isCorrect &= isSortedByIndicesAsStableSort<size_t>(arrays[indexOfArray]);
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSortIndices or applyPermutation differs from std::stable_sort");
+}
+
+class KeyOfPair
+{
+public:
+    unsigned int operator()(const std::pair<unsigned int, int> &element) const
+    {
+        return element.first;
+    }
+};
+
+///timSortHybrid of pairs by their first elements and of signed integers; besides arrays with equal keys, there are arrays, where sorted blocks
+///alternate with random ones of more than HYBRID_RADIX_SORT_MIN_SIZE elements, so both radix sorted stretches and long runs are merged
+void testTimSortHybrid(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    const size_t SIZE_OF_BLOCK = 2 * TimSortFunctionsAndClasses::HYBRID_RADIX_SORT_MIN_SIZE + 1;
+    
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    arrays.push_back(generateRunsOfPairs(length, SIZE_OF_BLOCK, 1000u, false));
+    std::vector<int> integers(length);
+    std::generate(integers.begin(), integers.end(), TimsortRand::generateInt);
+    for (size_t begin = 0; begin < length; begin += 2 * SIZE_OF_BLOCK)
+    {
+        for (size_t i = begin + SIZE_OF_BLOCK; i < std::min<size_t>(length, begin + 2 * SIZE_OF_BLOCK); ++i)
+        {
+            arrays.back()[i].first = TimsortRand::generateUnsignedInt() % 1000u;
+        }
+        std::sort(integers.begin() + begin, integers.begin() + std::min<size_t>(length, begin + SIZE_OF_BLOCK));
+    }
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [](std::vector<ElementType> &array)
+                                          {
+                                              timSortHybrid(array.begin(), array.end(), KeyOfPair());
+                                          }
+                                         );
+    }
+    isCorrect &= isSortedAsStableSort(
+                                      integers, std::less<int>(),
+                                      [](std::vector<int> &array)
+                                      {
+                                          timSortHybrid(array.begin(), array.end());
+                                      }
+                                     );
+    reportFeatureTest(isCorrect, numberOfTest, "timSortHybrid differs from std::stable_sort");
+}
+
+///timSortZip of keys and values, which are the first and the second elements of pairs with equal keys: values are integers or strings
+///(so they are not trivially moved), and the arrays shall be permuted as the pairs by std::stable_sort
+void testTimSortZip(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [](std::vector<ElementType> &array)
+                                          {
+                                              std::vector<unsigned int> keys(array.size());
+                                              std::vector<int> values(array.size());
+                                              for (size_t i = 0; i < array.size(); ++i)
+                                              {
+                                                  keys[i] = array[i].first;
+                                                  values[i] = array[i].second;
+                                              }
+                                              timSortZip(keys.begin(), keys.end(), values.begin());
+                                              for (size_t i = 0; i < array.size(); ++i)
+                                              {
+                                                  array[i] = ElementType(keys[i], values[i]);
+                                              }
+                                          }
+                                         );
+        isCorrect &= isSortedAsStableSort(
+                                          arrays[indexOfArray], SpecialPairComparator(),
+                                          [](std::vector<ElementType> &array)
+                                          {
+                                              std::vector<unsigned int> keys(array.size());
+                                              std::vector<std::string> values(array.size());
+                                              for (size_t i = 0; i < array.size(); ++i)
+                                              {
+                                                  keys[i] = array[i].first;
+                                                  values[i] = std::to_string(array[i].second);
+                                              }
+                                              timSortZip(keys.begin(), keys.end(), values.begin(), std::less<unsigned int>());
+                                              for (size_t i = 0; i < array.size(); ++i)
+                                              {
+                                                  array[i] = ElementType(keys[i], atoi(values[i].c_str()));
+                                              }
+                                          }
+                                         );
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSortZip differs from std::stable_sort");
+}
+
+///Strings of a common prefix and up to maxLengthOfSuffix random letters of a small alphabet, so there are many equal strings,
+///and some strings are prefixes of others; sorted blocks of blockSize strings (descending, if areBlocksDescending) make runs
+std::vector<std::string> generateStringsWithCommonPrefix(
+                                                         unsigned int length, const std::string &prefix, unsigned int maxLengthOfSuffix,
+                                                         unsigned int blockSize, bool areBlocksDescending
+                                                        )
+{
+    const unsigned int ALPHABET_SIZE = 3;
+    std::vector<std::string> result(length, prefix);
+    for (size_t i = 0; i < length; ++i)
+    {
+        unsigned int lengthOfSuffix = TimsortRand::generateUnsignedInt() % (maxLengthOfSuffix + 1);
+        for (unsigned int j = 0; j < lengthOfSuffix; ++j)
+        {
+            result[i] += static_cast<char>('a' + TimsortRand::generateUnsignedInt() % ALPHABET_SIZE);
+        }
+    }
+    for (size_t begin = 0; blockSize > 1 && begin < length; begin += blockSize)
+    {
+        std::vector<std::string>::iterator end = result.begin() + std::min<size_t>(length, begin + blockSize);
+        std::sort(result.begin() + begin, end);
+        if (areBlocksDescending)
+        {
+            std::reverse(result.begin() + begin, end);
+        }
+    }
+    return result;
+}
+
+///timSortStrings (LcpTimSorter) of strings with long common prefixes and many equal strings, random and made of ascending
+///or descending runs, compared with std::stable_sort
+void testTimSortStrings(unsigned int numberOfTest, unsigned int length)
+{
+    const std::string LONG_PREFIX = "https://example.com/some/long/path/to/the/resource/";
+    const unsigned int BLOCK_SIZES[] = {1u, 5u, 100u, length / 3u + 1u};
+    
+    bool isCorrect = true;
+    for (size_t indexOfBlockSize = 0; indexOfBlockSize < sizeof(BLOCK_SIZES) / sizeof(BLOCK_SIZES[0]); ++indexOfBlockSize)
+    {
+        for (int areBlocksDescending = 0; areBlocksDescending < 2; ++areBlocksDescending)
+        {
+            for (unsigned int maxLengthOfSuffix = 2; maxLengthOfSuffix <= 8; maxLengthOfSuffix += 6)
+            {
+                const std::string prefixes[] = {std::string(), LONG_PREFIX};
+                for (size_t indexOfPrefix = 0; indexOfPrefix < 2; ++indexOfPrefix)
+                {
+                    isCorrect &= isSortedAsStableSort(
+                                                      generateStringsWithCommonPrefix(
+                                                                                      length, prefixes[indexOfPrefix], maxLengthOfSuffix,
+                                                                                      BLOCK_SIZES[indexOfBlockSize], areBlocksDescending
+                                                                                     ),
+                                                      std::less<std::string>(),
+                                                      [](std::vector<std::string> &array)
+                                                      {
+                                                          timSortStrings(array.begin(), array.end());
+                                                      }
+                                                     );
+                }
+            }
+        }
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSortStrings differs from std::stable_sort");
+}
+
+///timSortPartial of pairs with equal keys for several numbers of the least elements: they shall be the prefix of std::stable_sort,
+///and the other elements shall be the rest of the array in some order
+void testTimSortPartial(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    const size_t NUMBERS_OF_LEAST_ELEMENTS[] = {0u, 1u, 10u, length / 100u, length / 3u, length - std::min(length, 1u), length};
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        std::vector<ElementType> expected = arrays[indexOfArray];
+        std::stable_sort(expected.begin(), expected.end(), SpecialPairComparator());
+        for (size_t indexOfNumber = 0; indexOfNumber < sizeof(NUMBERS_OF_LEAST_ELEMENTS) / sizeof(NUMBERS_OF_LEAST_ELEMENTS[0]); ++indexOfNumber)
+        {
+            size_t numberOfLeastElements = std::min<size_t>(length, NUMBERS_OF_LEAST_ELEMENTS[indexOfNumber]);
+            std::vector<ElementType> array = arrays[indexOfArray];
+            timSortPartial(array.begin(), array.begin() + numberOfLeastElements, array.end(), SpecialPairComparator());
+            isCorrect &= std::equal(array.begin(), array.begin() + numberOfLeastElements, expected.begin());
+            
+            std::sort(array.begin() + numberOfLeastElements, array.end());
+            std::vector<ElementType> rest(expected.begin() + numberOfLeastElements, expected.end());
+            std::sort(rest.begin(), rest.end());
+            isCorrect &= std::equal(rest.begin(), rest.end(), array.begin() + numberOfLeastElements);
+        }
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSortPartial differs from std::stable_sort or loses elements");
+}
+
+///timSort<TimSortPolicyTwo> and timSort with TimSortParametersTwo of pairs with equal keys: both shall sort as std::stable_sort
+///and do the same merges, since the policy is the inlined copy of the parameters
+void testTimSortPolicyTwo(unsigned int numberOfTest, unsigned int length)
+{
+    typedef std::pair<unsigned int, int> ElementType;
+    typedef std::vector<ElementType>::iterator Iterator;
+    std::vector<std::vector<ElementType> > arrays = generateArraysWithEqualKeys(length);
+    
+    bool isCorrect = true;
+    for (size_t indexOfArray = 0; indexOfArray < arrays.size(); ++indexOfArray)
+    {
+        std::vector<ElementType> arraySortedWithParameters = arrays[indexOfArray];
+        TimSortFunctionsAndClasses::TimSortWorkspace<Iterator, TimSortFunctionsAndClasses::TimSortStats> workspaceOfParameters;
+        isCorrect &= isSortedAsStableSort(
+                                          arraySortedWithParameters, SpecialPairComparator(),
+                                          [&workspaceOfParameters](std::vector<ElementType> &array)
+                                          {
+                                              timSort(
+                                                      array.begin(), array.end(),
+                                                      &TimSortFunctionsAndClasses::TimSortParametersTwo::TimSortParametersTwoObject,
+                                                      SpecialPairComparator(), workspaceOfParameters
+                                                     );
+                                          }
+                                         );
+        
+        std::vector<ElementType> arraySortedWithPolicy = arrays[indexOfArray];
+        TimSortFunctionsAndClasses::TimSortWorkspace<Iterator, TimSortFunctionsAndClasses::TimSortStats> workspaceOfPolicy;
+        isCorrect &= isSortedAsStableSort(
+                                          arraySortedWithPolicy, SpecialPairComparator(),
+                                          [&workspaceOfPolicy](std::vector<ElementType> &array)
+                                          {
+                                              timSort<TimSortFunctionsAndClasses::TimSortPolicyTwo>(
+                                                                                                   array.begin(), array.end(),
+                                                                                                   SpecialPairComparator(), workspaceOfPolicy
+                                                                                                  );
+                                          }
+                                         );
+        
+        const TimSortFunctionsAndClasses::TimSortStats &statsOfParameters = workspaceOfParameters.getStats();
+        const TimSortFunctionsAndClasses::TimSortStats &statsOfPolicy = workspaceOfPolicy.getStats();
+        isCorrect &= (statsOfParameters.merges == statsOfPolicy.merges);
+        isCorrect &= (statsOfParameters.mergedElements == statsOfPolicy.mergedElements);
+        isCorrect &= (statsOfParameters.gallopEntries == statsOfPolicy.gallopEntries);
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "timSort with TimSortPolicyTwo differs from timSort with TimSortParametersTwo");
+}
+
+unsigned int getFeatureTestParameter(int argc, char **argv, int indexOfParameter)
+{
+    if (argc <= indexOfParameter)
+    {
+        throw "Not enough parameters for the test\n";
+    }
+    return atoi(argv[indexOfParameter]);
+}
+
+///Concatenation of two sorted runs of pairs, keys of which are less than numberOfKeys; the second element of pair is its index in the concatenation
+std::vector<std::pair<unsigned int, int> > generateTwoRuns(size_t sizeOfFirst, size_t sizeOfSecond, unsigned int numberOfKeys)
+{
+    std::vector<std::pair<unsigned int, int> > result(sizeOfFirst + sizeOfSecond);
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i].first = TimsortRand::generateUnsignedInt() % numberOfKeys;
+    }
+    std::sort(result.begin(), result.begin() + sizeOfFirst, SpecialPairComparator());
+    std::sort(result.begin() + sizeOfFirst, result.end(), SpecialPairComparator());
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i].second = static_cast<int>(i);
+    }
+    return result;
+}
+
+///coRank of every number of the first elements is compared with the number of elements of the first run among the first elements of std::merge,
+///and results of parallelMerge with numbers of threads, which split the output at different places, are compared with std::merge
+bool isMergedAsStdMerge(const std::vector<std::pair<unsigned int, int> > &runs, size_t sizeOfFirst)
+{
+    typedef std::vector<std::pair<unsigned int, int> >::const_iterator Iterator;
+    const unsigned int NUMBERS_OF_THREADS[] = {2u, 3u, 4u, 7u};
+    
+    Iterator first = runs.begin();
+    Iterator middle = runs.begin() + sizeOfFirst;
+    std::vector<std::pair<unsigned int, int> > expected(runs.size());
+    std::merge(first, middle, middle, runs.end(), expected.begin(), SpecialPairComparator());
+    
+    bool isCorrect = true;
+    size_t fromFirstRun = 0;
+    for (size_t numberOfFirstElements = 0; numberOfFirstElements <= runs.size(); ++numberOfFirstElements)
+    {
+        isCorrect &= (TimSortFunctionsAndClasses::coRank(numberOfFirstElements, first, middle, runs.end(), SpecialPairComparator()) == fromFirstRun);
+        if (numberOfFirstElements < runs.size() && static_cast<size_t>(expected[numberOfFirstElements].second) < sizeOfFirst)
+        {
+            ++fromFirstRun;
+        }
+    }
+    
+    for (size_t indexOfThreads = 0; indexOfThreads < sizeof(NUMBERS_OF_THREADS) / sizeof(NUMBERS_OF_THREADS[0]); ++indexOfThreads)
+    {
+        std::vector<std::pair<unsigned int, int> > merged = runs;
+        parallelMerge(merged.begin(), merged.begin() + sizeOfFirst, merged.end(), SpecialPairComparator(), NUMBERS_OF_THREADS[indexOfThreads], 1u);
+        isCorrect &= (merged == expected);
+    }
+    return isCorrect;
+}
+
+///parallelMerge and coRank on balanced and unbalanced runs (one of them has about length / 100 elements, one element or none)
+///Keys are few or all equal, so runs of equal keys cross the borders of parts of output, and stability of split merges is checked
+void testParallelMerge(unsigned int numberOfTest, unsigned int length)
+{
+    const unsigned int NUMBERS_OF_KEYS[] = {1u, 10u};
+    const size_t SIZES_OF_RUNS[][2] = {
+                                       {length, length}, {length, length / 100 + 1}, {length / 100 + 1, length},
+                                       {length, 1u}, {1u, length}, {length, 0u}, {0u, length}
+                                      };
+    
+    bool isCorrect = true;
+    for (size_t indexOfKeys = 0; indexOfKeys < sizeof(NUMBERS_OF_KEYS) / sizeof(NUMBERS_OF_KEYS[0]); ++indexOfKeys)
+    {
+        for (size_t indexOfSizes = 0; indexOfSizes < sizeof(SIZES_OF_RUNS) / sizeof(SIZES_OF_RUNS[0]); ++indexOfSizes)
+        {
+            size_t sizeOfFirst = SIZES_OF_RUNS[indexOfSizes][0];
+            isCorrect &= isMergedAsStdMerge(generateTwoRuns(sizeOfFirst, SIZES_OF_RUNS[indexOfSizes][1], NUMBERS_OF_KEYS[indexOfKeys]), sizeOfFirst);
+        }
+    }
+    reportFeatureTest(isCorrect, numberOfTest, "parallelMerge or coRank differs from std::merge");
+}
+
+///Tests of features other than timSort; parameters follow typeOfTest in argv
+void testFeature(unsigned int numberOfTest, unsigned int typeOfTest, int argc, char **argv)
+{
+    switch (typeOfTest)
+    {
+        case 13u:
+            testParallelTimSort(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 14u:
+            testParallelMerge(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 15u:
+            testExternalTimSort(numberOfTest, getFeatureTestParameter(argc, argv, 3), getFeatureTestParameter(argc, argv, 4));
+            break;
+        case 16u:
+            testExternalTimSortFailure(numberOfTest, getFeatureTestParameter(argc, argv, 3), getFeatureTestParameter(argc, argv, 4));
+            break;
+        case 17u:
+            testIncrementalTimSorter(numberOfTest, getFeatureTestParameter(argc, argv, 3), getFeatureTestParameter(argc, argv, 4));
+            break;
+        case 18u:
+            testTimSortStatsOfEmptyRange(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 19u:
+            testPowersort(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 20u:
+            testBoundedMemoryTimSort(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 21u:
+            testTimSortByKey(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 22u:
+            testTimSortIndices(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 23u:
+            testTimSortHybrid(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 24u:
+            testTimSortZip(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 25u:
+            testTimSortStrings(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 26u:
+            testTimSortPartial(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        case 27u:
+            testTimSortPolicyTwo(numberOfTest, getFeatureTestParameter(argc, argv, 3));
+            break;
+        default:
+            throw "No such test type\n";
+    }
+}
+
 ///argv = [name, numberOfTest, typeOfTest, parameters..]
 ///typeOfTest == 1: generateRandomIntArray; parameters = length
 ///typeOfTest == 2: generatePartlySortedIntArray; parameters = numberOfParts, lengthOfEach
@@ -169,8 +1199,30 @@ void chooseComparatorAndTest(TestParameters currentParameters, SpecialCompare sp
 ///typeOfTest == 6: generatePartlySortePairArray; parameters = numberOfParts, lengthOfEach, useSpecialComparator
 ///typeOfTest == 7: generatePointArray; parameters = length
 ///typeOfTest == 8: generatePartlySortedPointArray; parameters = numberOfParts, lengthOfEach
+///typeOfTest == 9: generateMoveCountingArray; parameters = length
+///typeOfTest == 10: generatePartlySortedMoveCountingArray; parameters = numberOfParts, lengthOfEach
+///typeOfTest == 11: generateMoveOnlyArray; parameters = length
+///typeOfTest == 12: generatePartlySortedMoveOnlyArray; parameters = numberOfParts, lengthOfEach
+///typeOfTest == 13: parallelTimSort of random and partly sorted pair arrays with several numbers of threads; parameters = length
+///typeOfTest == 14: parallelMerge and coRank of balanced and unbalanced runs with equal keys; parameters = length
+///typeOfTest == 15: externalTimSort of a file of records with equal keys and check of its memory usage; parameters = numberOfRecords, memoryInKilobytes
+///typeOfTest == 16: externalTimSort with comparator, which throws, and check, that temporary files are removed; parameters = numberOfRecords, memoryInKilobytes
+///typeOfTest == 17: IncrementalTimSorter with batch boundaries inside ascending and descending runs and interleaved finish calls; parameters = length, batchSize
+///typeOfTest == 18: statistics of timSort of an empty range after a non-empty one with the same TimSortStats; parameters = length
+///typeOfTest == 19: timSort with TimSortPolicyPowersort of pairs with equal keys in random arrays and arrays of runs; parameters = length
+///typeOfTest == 20: timSort of pairs with equal keys and merge buffer limited by setMaxBufferBytes to several sizes down to 1 byte; parameters = length
+///typeOfTest == 21: timSortByKey of pairs with equal keys in ascending and descending order of keys; parameters = length
+///typeOfTest == 22: timSortIndices and applyPermutation of pairs with equal keys; parameters = length
+///typeOfTest == 23: timSortHybrid of pairs with equal keys and of integers, where sorted and random blocks alternate; parameters = length
+///typeOfTest == 24: timSortZip of keys with equal elements and of integer or string values; parameters = length
+///typeOfTest == 25: timSortStrings of equal strings and strings with long common prefixes in random order and in runs; parameters = length
+///typeOfTest == 26: timSortPartial of pairs with equal keys for several numbers of the least elements; parameters = length
+///typeOfTest == 27: timSort with TimSortPolicyTwo and with TimSortParametersTwo of pairs with equal keys, which shall do the same merges; parameters = length
 ///Notice, that if array not partly sorted, it can be treated as partly sorted with numberOfParts = length and lengthOfEach = 1. 
 ///Notice, that type 2 * i + 1 and 2 * i + 2 have equal type of elements, and the even one is partly sorted - this fact is used below
+///Types after LAST_TYPE_OF_SORT_TEST test other features (see testFeature)
+
+const unsigned int LAST_TYPE_OF_SORT_TEST = 12u;
 
 
 int main(int argc, char **argv)
@@ -189,6 +1241,12 @@ int main(int argc, char **argv)
     
     TimsortRand::srand(numberOfTest);
     
+    if (typeOfTest > LAST_TYPE_OF_SORT_TEST)
+    {
+        testFeature(numberOfTest, typeOfTest, argc, argv);
+        return 0;
+    }
+    
     if (typeOfTest % 2u == 0u)
     {
         if (argc <= 4)
@@ -202,7 +1260,7 @@ int main(int argc, char **argv)
     
     if (typeOfTest == 2u) ///string
     {
-        if (argc == argumentsShift)
+        if (static_cast<unsigned int>(argc) == argumentsShift)
         {
             throw "Not enough parameters - I can't distinguish string length\n";
         }
@@ -227,6 +1285,12 @@ int main(int argc, char **argv)
         case 4u:
             chooseComparatorAndTest<TimSortTestClasses::Point>(currentParameters, TimSortTestClasses::PointComparator(), TimSortTestClasses::PointComparator());
             break;
+        case 5u:
+            chooseComparatorAndTest<TimSortTestClasses::MoveCountingElement>(currentParameters);
+            break;
+        case 6u:
+            chooseComparatorAndTest<TimSortTestClasses::MoveOnlyElement>(currentParameters);
+            break;
         default:
             throw "No such test type\n";
     }
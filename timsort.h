@@ -2,7 +2,17 @@
 #define _TIM_SORT
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
 #include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 201703L
+#include <memory_resource>
+#endif
 
 
 namespace TimSortFunctionsAndClasses
@@ -21,30 +31,51 @@ namespace TimSortFunctionsAndClasses
         MERGE_NOTHING
     };
     
+    ///Merge decisions are made by sizes of the top runs (getMergeAction(sizeOfX, sizeOfY, sizeOfZ))
+    class RunSizesMergeDecision
+    {
+    };
+    
+    ///Merge decisions are made by node powers of the top runs (getMergeActionByPowers(powerOfX, powerOfY)), as in powersort
+    class NodePowerMergeDecision
+    {
+    };
+    
     class ITimSortParameters
     {
     public:
-        virtual MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY, unsigned int sizeOfZ) const = 0;
+        typedef RunSizesMergeDecision MergeDecisionType;
+        
+        virtual MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY, size_t sizeOfZ) const = 0;
         
-        virtual MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY) const = 0;
+        virtual MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY) const = 0;
         
-        virtual unsigned int getMinRun(unsigned int numberOfElements) const  = 0;
+        virtual unsigned int getMinRun(size_t numberOfElements) const  = 0;
         
+        ///Initial value of min_gallop: merge starts galloping after one run wins min_gallop times in a row
+        ///min_gallop adapts to data during timSort call
         virtual unsigned int getMergeStupidIterationsLimit() const = 0;
+        
+        ///Merge keeps galloping, while gallops move at least this number of elements
+        ///Not pure, so parameters, written before it appeared, still compile; returns TimSortPolicyDefault::GALLOP_SUCCESS_LIMIT
+        virtual unsigned int getGallopSuccessLimit() const;
     };
 
 
-    class TimSortParametersDefault: public ITimSortParameters
+    ///Compile-time analogue of ITimSortParameters: all functions are static, so timSort<Policy> calls them directly and they get inlined
+    ///Custom policies can inherit TimSortPolicyDefault and hide some of its functions
+    class TimSortPolicyDefault
     {
-    private:
+    public:
+        typedef RunSizesMergeDecision MergeDecisionType;
+        
         static const unsigned int MIN_RUN_CALC_BORDER = 64;
         
         static const unsigned int MERGE_STUPID_ITERATIONS_LIMIT = 7;
-    public:
         
-        TimSortParametersDefault(){}
+        static const unsigned int GALLOP_SUCCESS_LIMIT = 7;
         
-        MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY, unsigned int sizeOfZ) const
+        static MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY, size_t sizeOfZ)
         {
             if (sizeOfZ && sizeOfZ <= sizeOfY + sizeOfX)
             {
@@ -67,7 +98,7 @@ namespace TimSortFunctionsAndClasses
             }
         }
         
-        MergeActionType getMergeAction(unsigned int sizeOfX, unsigned int sizeOfY) const
+        static MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY)
         {
             if (sizeOfY <= sizeOfX)
             {
@@ -79,7 +110,7 @@ namespace TimSortFunctionsAndClasses
             }
         }
         
-        unsigned int getMinRun(unsigned int numberOfElements) const
+        static unsigned int getMinRun(size_t numberOfElements)
         {
             bool shallWeAddOneToMinRun = 0;
             while (numberOfElements >= MIN_RUN_CALC_BORDER)
@@ -90,279 +121,1196 @@ namespace TimSortFunctionsAndClasses
             return numberOfElements + shallWeAddOneToMinRun;
         }
         
-        unsigned int getMergeStupidIterationsLimit() const
+        static unsigned int getMergeStupidIterationsLimit()
         {
             return MERGE_STUPID_ITERATIONS_LIMIT;
         }
+        
+        static unsigned int getGallopSuccessLimit()
+        {
+            return GALLOP_SUCCESS_LIMIT;
+        }
     };
+    
+    inline unsigned int ITimSortParameters::getGallopSuccessLimit() const
+    {
+        return TimSortPolicyDefault::getGallopSuccessLimit();
+    }
 
 
-#ifdef _DEBUG_CNT_OPERATIONS
-    int insertionSortIterationsCnt;
-    int mergeOperationsCnt;
-#endif
-
-    template<class RandomAccessIterator>
-    class Run
+    ///Powersort (J. I. Munro, S. Wild): runs are merged in the order of the nearly optimal merge tree, built from node powers of boundaries between runs
+    ///Y and Z are merged, while power of the boundary before Y is greater than power of the boundary before X, so powers grow from bottom to top of stack
+    ///Stack depth is at most log2(numberOfElements) + 1
+    class TimSortPolicyPowersort : public TimSortPolicyDefault
     {
-        RandomAccessIterator iterator;
+    public:
+        typedef NodePowerMergeDecision MergeDecisionType;
         
-        unsigned int size;
+        static MergeActionType getMergeActionByPowers(unsigned int powerOfX, unsigned int powerOfY)
+        {
+            if (powerOfY > powerOfX)
+            {
+                return MERGE_ZY;
+            }
+            else
+            {
+                return MERGE_NOTHING;
+            }
+        }
+    };
+    
+    
+    class TimSortParametersDefault: public ITimSortParameters
+    {
     public:
-        Run()
+        
+        TimSortParametersDefault(){}
+        
+        MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY, size_t sizeOfZ) const
         {
+            return TimSortPolicyDefault::getMergeAction(sizeOfX, sizeOfY, sizeOfZ);
         }
         
-        Run(RandomAccessIterator iterator, unsigned int size) : iterator(iterator), size(size)
-        {    
+        MergeActionType getMergeAction(size_t sizeOfX, size_t sizeOfY) const
+        {
+            return TimSortPolicyDefault::getMergeAction(sizeOfX, sizeOfY);
         }
         
-        RandomAccessIterator getFirstIterator() const
+        unsigned int getMinRun(size_t numberOfElements) const
         {
-            return iterator;
+            return TimSortPolicyDefault::getMinRun(numberOfElements);
         }
         
-        RandomAccessIterator getLastIterator() const
+        unsigned int getMergeStupidIterationsLimit() const
+        {
+            return TimSortPolicyDefault::getMergeStupidIterationsLimit();
+        }
+    };
+
+
+    ///Phases of timSort call, time of which TimSortStats measures
+    enum TimSortPhase
+    {
+        PHASE_RUN_DETECTION,
+        PHASE_MERGE,
+        PHASE_NONE
+    };
+    
+    ///Observer of timSort call, which ignores everything: its functions are empty, so their calls compile to nothing
+    ///Observers are template parameters of MergeState and TimSortWorkspace; see TimSortStats for the meaning of functions
+    class NoTimSortStats
+    {
+    public:
+        void reset()
         {
-            return iterator + size;
         }
         
-        unsigned int getSize() const
+        template<class Compare>
+        Compare wrapComparator(Compare comp)
         {
-            return size;
+            return comp;
         }
         
-        void incrementSize()
+        void onNaturalRun(size_t)
         {
-            ++size;
         }
         
-        void addToSize(unsigned int addition)
+        void onMoves(size_t)
         {
-            size += addition;
         }
-    };
-
         
-    template<class RandomAccessIterator>
-    class StackOfRuns
+        void onMerge(size_t)
+        {
+        }
+        
+        void onGallopEntry()
+        {
+        }
+        
+        void onGallopSuccess()
+        {
+        }
+        
+        void onBufferCapacity(size_t)
+        {
+        }
+        
+        void switchPhase(TimSortPhase)
+        {
+        }
+    };
+    
+    ///Comparator, which counts its calls
+    template<class Compare>
+    class CountingComparator
     {
-        std::vector <Run<RandomAccessIterator> > body;
+        Compare comp;
+        
+        unsigned long long *counter;
     public:
-        void push(const Run<RandomAccessIterator> &element)
+        CountingComparator(Compare comp, unsigned long long *counter) : comp(comp), counter(counter)
         {
-            body.push_back(element);
         }
-
-        void pop()
+        
+        template<class FirstType, class SecondType>
+        bool operator()(const FirstType &first, const SecondType &second) const
         {
-            body.pop_back();
+            ++*counter;
+            return comp(first, second);
         }
-
-        unsigned int size() const
+    };
+    
+    ///Statistics of one timSort call: take it from TimSortWorkspace<RandomAccessIterator, TimSortStats> after the call
+    ///or pass it to timSort(first, last, comp, stats); it is reset at the beginning of each call
+    class TimSortStats
+    {
+        TimSortPhase currentPhase;
+        
+        std::chrono::steady_clock::time_point phaseBegin;
+    public:
+        unsigned long long comparisons;
+        
+        ///Elements moved by run reversals (3 moves per swap), insertion sorts and merges (moves to merge buffer and to places in range)
+        unsigned long long moves;
+        
+        ///Natural runs found by run detection (before they are extended to minRun)
+        unsigned long long naturalRuns;
+        
+        ///naturalRunLengthHistogram[i] is the number of natural runs of length in [2^i, 2^(i + 1))
+        std::vector<unsigned long long> naturalRunLengthHistogram;
+        
+        unsigned long long merges;
+        
+        ///Sum of sizes of merged pairs of runs (merge cost)
+        unsigned long long mergedElements;
+        
+        ///Number of times merges switched to galloping mode and number of galloping rounds, after which they stayed in it
+        unsigned long long gallopEntries;
+        
+        unsigned long long gallopSuccesses;
+        
+        ///The largest capacity of the merge buffer in bytes: memory, which it really held, not the part of it, which merges used
+        size_t peakBufferBytes;
+        
+        ///Time of run detection (including reversals and insertion sorts) and time of merges
+        double runDetectionSeconds;
+        
+        double mergeSeconds;
+        
+        TimSortStats()
         {
-            return body.size();
+            reset();
         }
-
-        const Run<RandomAccessIterator> &operator[](int i) const
+        
+        void reset()
         {
-            return body[static_cast<int> (size()) + i];
+            currentPhase = PHASE_NONE;
+            comparisons = 0;
+            moves = 0;
+            naturalRuns = 0;
+            naturalRunLengthHistogram.clear();
+            merges = 0;
+            mergedElements = 0;
+            gallopEntries = 0;
+            gallopSuccesses = 0;
+            peakBufferBytes = 0;
+            runDetectionSeconds = 0;
+            mergeSeconds = 0;
         }
         
         template<class Compare>
-        void mergeRuns(int indexOfSecondMergingElement, Compare comp, const ITimSortParameters* const params)
+        CountingComparator<Compare> wrapComparator(Compare comp)
         {
-            if (indexOfSecondMergingElement < -2 || indexOfSecondMergingElement > -1)
-                throw "unsupported merging";
-            Run<RandomAccessIterator> saved = operator[](-1);
-            if (indexOfSecondMergingElement != -1)
+            return CountingComparator<Compare>(comp, &comparisons);
+        }
+        
+        void onNaturalRun(size_t length)
+        {
+            ++naturalRuns;
+            size_t bucket = 0;
+            while (length >>= 1)
             {
-                pop();
+                ++bucket;
             }
-            merge(
-                  operator[](-2).getFirstIterator(), operator[](-1).getFirstIterator(),
-                  operator[](-1).getLastIterator(),
-                  comp,
-                  params
-                 );
-            body[static_cast<int>(size()) - 2].addToSize(operator[](-1).getSize());
-            pop();
-            if (indexOfSecondMergingElement != -1)
+            if (naturalRunLengthHistogram.size() <= bucket)
             {
-                push(saved);
+                naturalRunLengthHistogram.resize(bucket + 1);
             }
+            ++naturalRunLengthHistogram[bucket];
         }
-    };
-
-    
-    template<class RandomAccessIterator, class Compare>
-    bool compareElementWithPrevious(const RandomAccessIterator &iterator, Compare comp)
-    {
-        return comp(*iterator, *(iterator - 1));
-    }
-
-    template<class RandomAccessIterator>
-    void swapElementWithPrevious(const RandomAccessIterator &iterator)
-    {
-        std::swap(*iterator, *(iterator - 1));
-    }
         
-    template <class RandomAccessIterator, class Compare>
-    void insertionSort(const RandomAccessIterator &first, const RandomAccessIterator &last, Compare comp, unsigned int sortedSize)
-    {
-        for (RandomAccessIterator currentElement = first + sortedSize; currentElement != last; ++currentElement)
+        void onMoves(size_t numberOfMoves)
+        {
+            moves += numberOfMoves;
+        }
+        
+        void onMerge(size_t numberOfElements)
+        {
+            ++merges;
+            mergedElements += numberOfElements;
+        }
+        
+        void onGallopEntry()
+        {
+            ++gallopEntries;
+        }
+        
+        void onGallopSuccess()
+        {
+            ++gallopSuccesses;
+        }
+        
+        void onBufferCapacity(size_t numberOfBytes)
         {
-            RandomAccessIterator elementToSwapBack = currentElement;
-            while (elementToSwapBack != first && compareElementWithPrevious(elementToSwapBack, comp))
+            peakBufferBytes = std::max(peakBufferBytes, numberOfBytes);
+        }
+        
+        ///Adds time since the previous switch to the current phase
+        void switchPhase(TimSortPhase phase)
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            double seconds = std::chrono::duration<double>(now - phaseBegin).count();
+            if (currentPhase == PHASE_RUN_DETECTION)
+            {
+                runDetectionSeconds += seconds;
+            }
+            else if (currentPhase == PHASE_MERGE)
             {
-    #ifdef _DEBUG_CNT_OPERATIONS
-                ++insertionSortIterationsCnt;
-    #endif
-                //std::swap(*elementToSwapBack, *(elementToSwapBack - 1));
-                swapElementWithPrevious(elementToSwapBack--);
+                mergeSeconds += seconds;
             }
+            currentPhase = phase;
+            phaseBegin = now;
         }
-    }
+    };
 
-    
-    template<class RandomAccessIterator, class OutputIterator, class TypeOfValueToCompareWith, class Compare>
-    void doMove(
-                RandomAccessIterator &begin, const RandomAccessIterator &end, const TypeOfValueToCompareWith &valueToCompareWith,
-                OutputIterator &output, BoundType boundType, Compare comp
-               )
+    ///Scratch memory of merges and min_gallop, which adapts during timSort call, and observer of the call
+    ///Buffer only grows (geometrically), so after a few merges no more allocations are done
+    ///Buffer never holds more than maxBufferSize elements: merges, which need more, are split by rotations (see mergeWithRotations)
+    ///Buffer memory is taken from allocator, e.g. std::pmr::polymorphic_allocator of an arena
+    template<class ValueType, class Stats = NoTimSortStats, class Allocator = std::allocator<ValueType> >
+    class MergeState
     {
-        RandomAccessIterator nextElementIterator;
+        std::vector<ValueType, Allocator> buffer;
         
-        if (boundType == EBT_LOWER_BOUND)
+        size_t maxBufferSize;
+        
+        size_t minGallop;
+        
+        Stats stats;
+    public:
+        explicit MergeState(const Allocator &allocator = Allocator()) : buffer(allocator), maxBufferSize(static_cast<size_t>(-1)), minGallop(0)
         {
-            nextElementIterator = std::lower_bound(begin, end, valueToCompareWith, comp);
         }
-        else
+        
+        size_t getMaxBufferSize() const
         {
-            nextElementIterator = std::upper_bound(begin, end, valueToCompareWith, comp);
+            return maxBufferSize;
         }
         
-        std::copy(begin, nextElementIterator, output);
-        output += (nextElementIterator - begin);
-        begin = nextElementIterator;
-    }
-
-
-    template <class RandomAccessIterator, class Compare>
-    void mergeLeft(
-                   const RandomAccessIterator &first, const RandomAccessIterator &middle,
-                   const RandomAccessIterator &last, Compare comp,
-                   const ITimSortParameters* const params
-                  )
-    {
+        ///newMaxBufferSize shall be positive; memory of the buffer is released, if it is larger
+        void setMaxBufferSize(size_t newMaxBufferSize)
+        {
+            maxBufferSize = newMaxBufferSize;
+            if (buffer.capacity() > maxBufferSize)
+            {
+                releaseBuffer();
+            }
+        }
         
-#ifdef _USE_STD_INPLACE_MERGE
-        return void(std::inplace_merge(first, middle, last, comp));
-#endif
+        ///Destroys content of the buffer and releases its memory
+        void releaseBuffer()
+        {
+            std::vector<ValueType, Allocator>(buffer.get_allocator()).swap(buffer);
+        }
         
-        std::vector <typename std::iterator_traits<RandomAccessIterator>::value_type> temporary(first, middle);
-        typename std::vector <typename std::iterator_traits<RandomAccessIterator>::value_type>::iterator pointerToElementInFirstArray = temporary.begin();
+        Stats &getStats()
+        {
+            return stats;
+        }
         
-        RandomAccessIterator pointerToElementInSecondArray = middle;
-        RandomAccessIterator placeToInsert = first;
+        size_t getMinGallop() const
+        {
+            return minGallop;
+        }
         
-        unsigned int sameLastMove = 0;
-        bool typeOfLastMove = 0;
+        void setMinGallop(size_t newMinGallop)
+        {
+            minGallop = newMinGallop;
+        }
         
-        while (pointerToElementInFirstArray != temporary.end() && pointerToElementInSecondArray != last)
+        typedef typename std::vector<ValueType, Allocator>::iterator BufferIterator;
+        
+        ///Move-constructs [first, last) into the beginning of buffer and returns it; elements don't need default constructor
+        ///Old content of the buffer is garbage (moved-from elements), so it is destroyed, and memory is released before larger one is reserved
+        template<class RandomAccessIterator>
+        BufferIterator moveToBuffer(const RandomAccessIterator &first, const RandomAccessIterator &last)
         {
-            bool typeOfCurrentMove = comp(*pointerToElementInSecondArray, *pointerToElementInFirstArray);
-            if (typeOfCurrentMove != typeOfLastMove)
-                sameLastMove = 0;
-            ++sameLastMove;
-            typeOfLastMove = typeOfCurrentMove;
-            
-#ifndef _DISABLE_GALOP
-            if (sameLastMove != params->getMergeStupidIterationsLimit())
-#else
-            if (true)
-#endif
+            size_t requiredSize = last - first;
+            buffer.clear();
+            if (buffer.capacity() < requiredSize)
             {
-                *(placeToInsert++) = (typeOfCurrentMove ? *(pointerToElementInSecondArray++) : *(pointerToElementInFirstArray++));
+                size_t newSize = std::max(requiredSize, std::min(2 * buffer.capacity(), maxBufferSize));
+                releaseBuffer();
+                buffer.reserve(newSize);
             }
-            else
+            stats.onBufferCapacity(buffer.capacity() * sizeof(ValueType));
+            buffer.insert(buffer.end(), std::make_move_iterator(first), std::make_move_iterator(last));
+            return buffer.begin();
+        }
+    };
+    
+    
+    ///Node power of the boundary between neighbouring runs of sizes sizeOfFirst and sizeOfSecond, the first of which starts at offsetOfFirst,
+    ///in the array of numberOfElements elements: the number of the first bit, in which binary fractions (middle of the first run) / numberOfElements
+    ///and (middle of the second run) / numberOfElements differ, i.e. the depth of the boundary in the perfectly balanced merge tree
+    inline unsigned int getNodePower(size_t offsetOfFirst, size_t sizeOfFirst, size_t sizeOfSecond, size_t numberOfElements)
+    {
+        unsigned long long doubledMiddleOfFirst = 2ull * offsetOfFirst + sizeOfFirst;
+        unsigned long long doubledMiddleOfSecond = doubledMiddleOfFirst + sizeOfFirst + sizeOfSecond;
+        unsigned int power = 0;
+        
+        while (true)
+        {
+            ++power;
+            if (doubledMiddleOfFirst >= numberOfElements)
             {
-                if (typeOfLastMove)
-                {
-                    doMove(pointerToElementInSecondArray, last, *pointerToElementInFirstArray, placeToInsert, EBT_LOWER_BOUND, comp);
-                }
-                else
-                {
-                    doMove(pointerToElementInFirstArray, temporary.end(), *pointerToElementInSecondArray, placeToInsert, EBT_UPPER_BOUND, comp);
-                }
-                sameLastMove = 0;
+                doubledMiddleOfFirst -= numberOfElements;
+                doubledMiddleOfSecond -= numberOfElements;
+            }
+            else if (doubledMiddleOfSecond >= numberOfElements)
+            {
+                return power;
             }
+            doubledMiddleOfFirst <<= 1;
+            doubledMiddleOfSecond <<= 1;
         }
-        
-        std::copy(pointerToElementInFirstArray, temporary.end(), placeToInsert);
     }
-
-    template<class Compare>
-    class ReverseComparator
+    
+    
+    ///Run is stored as offset from the beginning of sorted range and size
+    ///power is node power of the boundary between the run and the previous one in stack (0 for the first run)
+    class Run
     {
-        Compare comp;
-
-    public:   
-        ReverseComparator(const Compare &comp) : comp(comp)
+        size_t offset;
+        
+        size_t size;
+        
+        unsigned int power;
+    public:
+        Run()
         {
         }
-    
-        template<class ElementType>
-        bool operator()(const ElementType &first, const ElementType &second) const
+        
+        Run(size_t offset, size_t size, unsigned int power = 0u) : offset(offset), size(size), power(power)
+        {    
+        }
+        
+        size_t getOffset() const
         {
-            return comp(second, first);
+            return offset;
         }
-    };
-
-    template <class RandomAccessIterator, class Compare>
-    void mergeRight(
-                    const RandomAccessIterator &first, const RandomAccessIterator &middle,
-                    const RandomAccessIterator &last, Compare comp,
-                    const ITimSortParameters* const params
-                   )
-    {
-        typedef std::reverse_iterator<RandomAccessIterator> RIter;
-        mergeLeft(RIter(last), RIter(middle), RIter(first), ReverseComparator<decltype(comp)>(comp), params);
-    }
-    
-
-    template <class RandomAccessIterator, class Compare>
-    void merge(
-               const RandomAccessIterator &first, const RandomAccessIterator &middle,
-               const RandomAccessIterator &last, Compare comp,
-               const ITimSortParameters* const params
-              )
-    {   
-#ifdef _DEBUG_CNT_OPERATIONS
-        mergeOperationsCnt += (last - first);
-#endif
         
-        if (middle - first <= last - middle)
+        size_t getSize() const
         {
-            mergeLeft(first, middle, last, comp, params);
+            return size;
         }
-        else
+        
+        unsigned int getPower() const
         {
-            mergeRight(first, middle, last, comp, params);
+            return power;
         }
-    }
-
-
-    ///Takes currentElement iterator and stack
-    ///Pushes next Run into stack
-    ///After procedure, currentElement iterator points to the first element of next run or to the last element
-    template<class RandomAccessIterator, class Compare>
+        
+        void setPower(unsigned int newPower)
+        {
+            power = newPower;
+        }
+        
+        void incrementSize()
+        {
+            ++size;
+        }
+        
+        void addToSize(size_t addition)
+        {
+            size += addition;
+        }
+    };
+
+
+    ///Stack invariants of timSort (run sizes grow at least as Fibonacci numbers) and of powersort (node powers grow)
+    ///keep less than this number of runs for 2^64 elements; if custom parameters leave more, top runs are merged (see processCurrentStackOfRuns)
+    const unsigned int MAX_NUMBER_OF_RUNS_IN_STACK = 128;
+
+    ///Runs are kept in array inside the stack, so it never allocates memory
+    template<class RandomAccessIterator>
+    class StackOfRuns
+    {
+        RandomAccessIterator first;
+        
+        size_t numberOfElements;
+        
+        unsigned int numberOfRuns;
+        
+        Run body[MAX_NUMBER_OF_RUNS_IN_STACK];
+    public:
+        StackOfRuns() : first(), numberOfElements(0), numberOfRuns(0)
+        {
+        }
+        
+        ///Stack shall not be full
+        void push(const Run &element)
+        {
+            body[numberOfRuns++] = element;
+        }
+
+        void pop()
+        {
+            --numberOfRuns;
+        }
+
+        unsigned int size() const
+        {
+            return numberOfRuns;
+        }
+        
+        bool isFull() const
+        {
+            return numberOfRuns == MAX_NUMBER_OF_RUNS_IN_STACK;
+        }
+        
+        ///Removes all runs and prepares stack for runs of [first, first + numberOfElements)
+        void reset(const RandomAccessIterator &newFirst, size_t newNumberOfElements)
+        {
+            first = newFirst;
+            numberOfElements = newNumberOfElements;
+            numberOfRuns = 0;
+        }
+
+        ///Moves runs to the range [newFirst, newFirst + newNumberOfElements), e.g. after the container with sorted range was reallocated or grew
+        ///Runs are stored as offsets, so they stay valid
+        void rebase(const RandomAccessIterator &newFirst, size_t newNumberOfElements)
+        {
+            first = newFirst;
+            numberOfElements = newNumberOfElements;
+        }
+
+        const Run &operator[](int i) const
+        {
+            return body[static_cast<int> (size()) + i];
+        }
+        
+        size_t getOffset(const RandomAccessIterator &iterator) const
+        {
+            return iterator - first;
+        }
+        
+        RandomAccessIterator getFirstIterator(const Run &run) const
+        {
+            return first + run.getOffset();
+        }
+        
+        RandomAccessIterator getLastIterator(const Run &run) const
+        {
+            return first + (run.getOffset() + run.getSize());
+        }
+        
+        ///Returns node power of the boundary between the top run and nextRun, which starts right after it
+        unsigned int getNodePowerBefore(const Run &nextRun) const
+        {
+            if (numberOfRuns == 0)
+            {
+                return 0;
+            }
+            const Run &top = body[numberOfRuns - 1];
+            return getNodePower(top.getOffset(), top.getSize(), nextRun.getSize(), numberOfElements);
+        }
+        
+        ///Replaces run number indexOfSecondMergingElement (-1 for the top one, i.e. YX merge, or -2, i.e. ZY merge) and the previous run,
+        ///which are already merged, with one run; for ZY merge the top run moves one position down
+        void joinRuns(int indexOfSecondMergingElement)
+        {
+            unsigned int indexOfSecond = numberOfRuns + indexOfSecondMergingElement;
+            body[indexOfSecond - 1].addToSize(body[indexOfSecond].getSize());
+            if (indexOfSecondMergingElement == -2)
+            {
+                body[indexOfSecond] = body[indexOfSecond + 1];
+            }
+            pop();
+        }
+
+        ///Merges run number indexOfSecondMergingElement into the previous run in place (see joinRuns)
+        template<class Compare, class Parameters, class Stats, class Allocator>
+        void mergeRuns(
+                       int indexOfSecondMergingElement, Compare comp, const Parameters &params,
+                       MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                      )
+        {
+            if (indexOfSecondMergingElement < -2 || indexOfSecondMergingElement > -1)
+                throw "unsupported merging";
+            const Run &firstRun = operator[](indexOfSecondMergingElement - 1);
+            const Run &secondRun = operator[](indexOfSecondMergingElement);
+            merge(
+                  getFirstIterator(firstRun), getFirstIterator(secondRun),
+                  getLastIterator(secondRun),
+                  comp,
+                  params,
+                  mergeState
+                 );
+            joinRuns(indexOfSecondMergingElement);
+        }
+    };
+
+    
+    template<class RandomAccessIterator, class Compare>
+    bool compareElementWithPrevious(const RandomAccessIterator &iterator, Compare comp)
+    {
+        return comp(*iterator, *(iterator - 1));
+    }
+
+    template<class Compare>
+    class ReverseComparator
+    {
+        Compare comp;
+
+    public:   
+        ReverseComparator(const Compare &comp) : comp(comp)
+        {
+        }
+    
+        template<class ElementType>
+        bool operator()(const ElementType &first, const ElementType &second) const
+        {
+            return comp(second, first);
+        }
+    };
+
+    ///Comparisons of arithmetic types (and pairs of them) with std::less or std::greater are cheap and branch mispredictions cost more than comparisons
+    template<class ValueType, class Compare>
+    class IsCheapComparison : public std::false_type
+    {
+    };
+    
+    template<class ValueType>
+    class IsCheapComparison<ValueType, std::less<ValueType> > : public std::is_arithmetic<ValueType>
+    {
+    };
+    
+    template<class ValueType>
+    class IsCheapComparison<ValueType, std::greater<ValueType> > : public std::is_arithmetic<ValueType>
+    {
+    };
+    
+    template<class FirstType, class SecondType>
+    class IsCheapComparison<std::pair<FirstType, SecondType>, std::less<std::pair<FirstType, SecondType> > > :
+        public std::integral_constant<bool, std::is_arithmetic<FirstType>::value && std::is_arithmetic<SecondType>::value>
+    {
+    };
+    
+    template<class ValueType, class Compare>
+    class IsCheapComparison<ValueType, ReverseComparator<Compare> > : public IsCheapComparison<ValueType, Compare>
+    {
+    };
+    
+    ///Counting comparisons doesn't change the choice of algorithms
+    template<class ValueType, class Compare>
+    class IsCheapComparison<ValueType, CountingComparator<Compare> > : public IsCheapComparison<ValueType, Compare>
+    {
+    };
+    
+    ///Returns the first element of [first, last), which is greater than value (as std::upper_bound)
+    ///Binary search is done with conditional moves instead of branches, [first, last) shall be nonempty
+    template<class RandomAccessIterator, class TypeOfValueToCompareWith, class Compare>
+    RandomAccessIterator branchlessUpperBound(
+                                              RandomAccessIterator first, const RandomAccessIterator &last,
+                                              const TypeOfValueToCompareWith &value, Compare comp
+                                             )
+    {
+        size_t length = last - first;
+        while (length > 1)
+        {
+            size_t half = length / 2;
+            first += comp(value, *(first + half)) ? 0 : half;
+            length -= half;
+        }
+        return first + !comp(value, *first);
+    }
+    
+    template <class RandomAccessIterator, class TypeOfValueToCompareWith, class Compare>
+    RandomAccessIterator findPlaceToInsert(
+                                           const RandomAccessIterator &first, const RandomAccessIterator &last,
+                                           const TypeOfValueToCompareWith &value, Compare comp,
+                                           std::true_type
+                                          )
+    {
+        return branchlessUpperBound(first, last, value, comp);
+    }
+    
+    template <class RandomAccessIterator, class TypeOfValueToCompareWith, class Compare>
+    RandomAccessIterator findPlaceToInsert(
+                                           const RandomAccessIterator &first, const RandomAccessIterator &last,
+                                           const TypeOfValueToCompareWith &value, Compare comp,
+                                           std::false_type
+                                          )
+    {
+        return std::upper_bound(first, last, value, comp);
+    }
+    
+    ///Sorts [first, last), if [first, first + sortedSize) is already sorted and sortedSize > 0
+    ///Place of each next element is found with binary search, then all greater elements are shifted by one at once
+    template <class RandomAccessIterator, class Compare, class Stats>
+    void insertionSort(const RandomAccessIterator &first, const RandomAccessIterator &last, Compare comp, size_t sortedSize, Stats &stats)
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+        
+        for (RandomAccessIterator currentElement = first + sortedSize; currentElement != last; ++currentElement)
+        {
+            RandomAccessIterator placeToInsert = findPlaceToInsert(
+                                                                   first, currentElement, *currentElement, comp,
+                                                                   typename IsCheapComparison<ValueType, Compare>::type()
+                                                                  );
+            if (placeToInsert != currentElement)
+            {
+                stats.onMoves((currentElement - placeToInsert) + 2);
+                ValueType element = std::move(*currentElement);
+                std::move_backward(placeToInsert, currentElement, currentElement + 1);
+                *placeToInsert = std::move(element);
+            }
+        }
+    }
+    
+    template <class RandomAccessIterator, class Compare>
+    void insertionSort(const RandomAccessIterator &first, const RandomAccessIterator &last, Compare comp, size_t sortedSize)
+    {
+        NoTimSortStats stats;
+        insertionSort(first, last, comp, sortedSize, stats);
+    }
+
+    
+    ///Returns true, if element shall be placed before valueToCompareWith:
+    ///if boundType == EBT_LOWER_BOUND, only elements less than valueToCompareWith are placed before it, otherwise equal elements are placed before it too
+    template<class ElementType, class TypeOfValueToCompareWith, class Compare>
+    bool isPlacedBefore(const ElementType &element, const TypeOfValueToCompareWith &valueToCompareWith, BoundType boundType, Compare comp)
+    {
+        if (boundType == EBT_LOWER_BOUND)
+        {
+            return comp(element, valueToCompareWith);
+        }
+        else
+        {
+            return !comp(valueToCompareWith, element);
+        }
+    }
+    
+    ///Works as std::lower_bound (boundType == EBT_LOWER_BOUND) or std::upper_bound (boundType == EBT_UPPER_BOUND) on [begin, end),
+    ///but starts from begin + hint and checks positions hint +- 1, 3, 7, ..., 2^k - 1 first, then does binary search between last two of them
+    ///So it makes O(log(distance between hint and answer)) comparisons
+    template<class RandomAccessIterator, class TypeOfValueToCompareWith, class Compare>
+    RandomAccessIterator gallop(
+                                const TypeOfValueToCompareWith &valueToCompareWith,
+                                const RandomAccessIterator &begin, const RandomAccessIterator &end,
+                                size_t hint, BoundType boundType, Compare comp
+                               )
+    {
+        size_t size = end - begin;
+        if (size == 0)
+        {
+            return begin;
+        }
+        
+        RandomAccessIterator hintIterator = begin + hint;
+        RandomAccessIterator searchBegin, searchEnd;
+        size_t lastOffset = 0;
+        size_t offset = 1;
+        
+        if (isPlacedBefore(*hintIterator, valueToCompareWith, boundType, comp))
+        {
+            ///answer is in (hint + lastOffset, hint + offset]
+            size_t maxOffset = size - hint;
+            while (offset < maxOffset && isPlacedBefore(*(hintIterator + offset), valueToCompareWith, boundType, comp))
+            {
+                lastOffset = offset;
+                offset = 2 * offset + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            searchBegin = hintIterator + (lastOffset + 1);
+            searchEnd = hintIterator + offset;
+        }
+        else
+        {
+            ///answer is in (hint - offset, hint - lastOffset]
+            size_t maxOffset = hint + 1;
+            while (offset < maxOffset && !isPlacedBefore(*(hintIterator - offset), valueToCompareWith, boundType, comp))
+            {
+                lastOffset = offset;
+                offset = 2 * offset + 1;
+            }
+            offset = std::min(offset, maxOffset);
+            searchBegin = hintIterator - (offset - 1);
+            searchEnd = hintIterator - lastOffset;
+        }
+        
+        if (boundType == EBT_LOWER_BOUND)
+        {
+            return std::lower_bound(searchBegin, searchEnd, valueToCompareWith, comp);
+        }
+        else
+        {
+            return std::upper_bound(searchBegin, searchEnd, valueToCompareWith, comp);
+        }
+    }
+    
+    ///Gallops from begin to the place of valueToCompareWith and moves all elements, which are passed, to output
+    ///Returns number of moved elements
+    template<class RandomAccessIterator, class OutputIterator, class TypeOfValueToCompareWith, class Compare>
+    size_t doMove(
+                  RandomAccessIterator &begin, const RandomAccessIterator &end, const TypeOfValueToCompareWith &valueToCompareWith,
+                  OutputIterator &output, BoundType boundType, Compare comp
+                 )
+    {
+        RandomAccessIterator nextElementIterator = gallop(valueToCompareWith, begin, end, 0, boundType, comp);
+        size_t numberOfMovedElements = nextElementIterator - begin;
+        
+        output = std::move(begin, nextElementIterator, output);
+        begin = nextElementIterator;
+        return numberOfMovedElements;
+    }
+    
+    ///Mirror of doMove: gallops from end to the place of valueToCompareWith and moves all elements, which are passed, to output, which goes backwards
+    template<class RandomAccessIterator, class OutputIterator, class TypeOfValueToCompareWith, class Compare>
+    size_t doMoveBackward(
+                          const RandomAccessIterator &begin, RandomAccessIterator &end, const TypeOfValueToCompareWith &valueToCompareWith,
+                          OutputIterator &output, BoundType boundType, Compare comp
+                         )
+    {
+        RandomAccessIterator nextEnd = gallop(valueToCompareWith, begin, end, (end - begin) - 1, boundType, comp);
+        size_t numberOfMovedElements = end - nextEnd;
+        
+        output = std::move_backward(nextEnd, end, output);
+        end = nextEnd;
+        return numberOfMovedElements;
+    }
+
+
+    ///Moves elements from two sorted ranges to output one by one, until one of ranges ends, or one of them wins minGallop times in a row
+    ///winsOfFirst and winsOfSecond are set to the number of the last wins in a row of each range
+    template<class FirstIterator, class SecondIterator, class OutputIterator, class Compare>
+    void mergeOneByOne(
+                       FirstIterator &first, const FirstIterator &firstEnd, SecondIterator &second, const SecondIterator &secondEnd,
+                       OutputIterator &output, Compare comp, size_t minGallop, size_t &winsOfFirst, size_t &winsOfSecond,
+                       std::false_type
+                      )
+    {
+#ifdef _DISABLE_GALOP
+        ///ranges are merged to the end without galloping, so minGallop is not used
+        static_cast<void>(minGallop);
+#endif
+        while (first != firstEnd && second != secondEnd)
+        {
+            if (comp(*second, *first))
+            {
+                *(output++) = std::move(*(second++));
+                winsOfFirst = 0;
+                ++winsOfSecond;
+            }
+            else
+            {
+                *(output++) = std::move(*(first++));
+                winsOfSecond = 0;
+                ++winsOfFirst;
+            }
+#ifndef _DISABLE_GALOP
+            if (winsOfFirst >= minGallop || winsOfSecond >= minGallop)
+            {
+                break;
+            }
+#endif
+        }
+    }
+    
+    ///The same for cheap comparisons: result of comparison is not branched on, element and iterators are chosen by conditional moves,
+    ///so random data does not cause branch mispredictions; ties are resolved as above, so merge stays stable
+    template<class FirstIterator, class SecondIterator, class OutputIterator, class Compare>
+    void mergeOneByOne(
+                       FirstIterator &first, const FirstIterator &firstEnd, SecondIterator &second, const SecondIterator &secondEnd,
+                       OutputIterator &output, Compare comp, size_t minGallop, size_t &winsOfFirst, size_t &winsOfSecond,
+                       std::true_type
+                      )
+    {
+#ifdef _DISABLE_GALOP
+        ///ranges are merged to the end without galloping, so minGallop is not used
+        static_cast<void>(minGallop);
+#endif
+        while (first != firstEnd && second != secondEnd)
+        {
+            bool isSecondTaken = comp(*second, *first);
+            *(output++) = (isSecondTaken ? *second : *first);
+            second += isSecondTaken;
+            first += !isSecondTaken;
+            winsOfSecond = (winsOfSecond + 1) * isSecondTaken;
+            winsOfFirst = (winsOfFirst + 1) * !isSecondTaken;
+#ifndef _DISABLE_GALOP
+            if (winsOfFirst >= minGallop || winsOfSecond >= minGallop)
+            {
+                break;
+            }
+#endif
+        }
+    }
+    
+    ///Mirror of mergeOneByOne: moves the greatest of the last elements of [firstBegin, firstEnd) and [secondBegin, secondEnd) to output, which goes backwards,
+    ///and moves firstEnd or secondEnd back; of equal elements the one of the second range is taken, so merge stays stable
+    template<class FirstIterator, class SecondIterator, class OutputIterator, class Compare>
+    void mergeOneByOneBackward(
+                               const FirstIterator &firstBegin, FirstIterator &firstEnd, const SecondIterator &secondBegin, SecondIterator &secondEnd,
+                               OutputIterator &output, Compare comp, size_t minGallop, size_t &winsOfFirst, size_t &winsOfSecond,
+                               std::false_type
+                              )
+    {
+#ifdef _DISABLE_GALOP
+        static_cast<void>(minGallop);
+#endif
+        while (firstEnd != firstBegin && secondEnd != secondBegin)
+        {
+            if (comp(*(secondEnd - 1), *(firstEnd - 1)))
+            {
+                *(--output) = std::move(*(--firstEnd));
+                winsOfSecond = 0;
+                ++winsOfFirst;
+            }
+            else
+            {
+                *(--output) = std::move(*(--secondEnd));
+                winsOfFirst = 0;
+                ++winsOfSecond;
+            }
+#ifndef _DISABLE_GALOP
+            if (winsOfFirst >= minGallop || winsOfSecond >= minGallop)
+            {
+                break;
+            }
+#endif
+        }
+    }
+    
+    template<class FirstIterator, class SecondIterator, class OutputIterator, class Compare>
+    void mergeOneByOneBackward(
+                               const FirstIterator &firstBegin, FirstIterator &firstEnd, const SecondIterator &secondBegin, SecondIterator &secondEnd,
+                               OutputIterator &output, Compare comp, size_t minGallop, size_t &winsOfFirst, size_t &winsOfSecond,
+                               std::true_type
+                              )
+    {
+#ifdef _DISABLE_GALOP
+        static_cast<void>(minGallop);
+#endif
+        while (firstEnd != firstBegin && secondEnd != secondBegin)
+        {
+            bool isFirstTaken = comp(*(secondEnd - 1), *(firstEnd - 1));
+            *(--output) = (isFirstTaken ? *(firstEnd - 1) : *(secondEnd - 1));
+            firstEnd -= isFirstTaken;
+            secondEnd -= !isFirstTaken;
+            winsOfFirst = (winsOfFirst + 1) * isFirstTaken;
+            winsOfSecond = (winsOfSecond + 1) * !isFirstTaken;
+#ifndef _DISABLE_GALOP
+            if (winsOfFirst >= minGallop || winsOfSecond >= minGallop)
+            {
+                break;
+            }
+#endif
+        }
+    }
+    
+
+    ///Merges [first, middle) and [middle, last), using buffer of (middle - first) elements
+    ///Elements are merged one by one, until one run wins getMergeStupidIterationsLimit() (adaptive min_gallop, stored in mergeState) times in a row
+    ///After that merge gallops, while gallops move at least getGallopSuccessLimit() elements
+    ///min_gallop decreases with each successful galloping round and increases, when galloping ends, so it adapts to data during the whole timSort call
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void mergeLeft(
+                   const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                   const RandomAccessIterator &last, Compare comp,
+                   const Parameters &params,
+                   MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                  )
+    {
+        
+#ifdef _USE_STD_INPLACE_MERGE
+        return void(std::inplace_merge(first, middle, last, comp));
+#endif
+        
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+        typedef typename MergeState<ValueType, Stats, Allocator>::BufferIterator BufferIterator;
+        
+        BufferIterator temporaryBegin = mergeState.moveToBuffer(first, middle);
+        BufferIterator temporaryEnd = temporaryBegin + (middle - first);
+        BufferIterator pointerToElementInFirstArray = temporaryBegin;
+        
+        RandomAccessIterator pointerToElementInSecondArray = middle;
+        RandomAccessIterator placeToInsert = first;
+        
+        size_t minGallop = mergeState.getMinGallop();
+        const size_t gallopSuccessLimit = params.getGallopSuccessLimit();
+        
+        while (pointerToElementInFirstArray != temporaryEnd && pointerToElementInSecondArray != last)
+        {
+            size_t winsOfFirstArray = 0;
+            size_t winsOfSecondArray = 0;
+            
+            mergeOneByOne(
+                          pointerToElementInFirstArray, temporaryEnd, pointerToElementInSecondArray, last,
+                          placeToInsert, comp, minGallop, winsOfFirstArray, winsOfSecondArray,
+                          typename IsCheapComparison<ValueType, Compare>::type()
+                         );
+            if (pointerToElementInFirstArray == temporaryEnd || pointerToElementInSecondArray == last)
+            {
+                break;
+            }
+            
+            ++minGallop;
+            mergeState.getStats().onGallopEntry();
+            bool isGallopSuccessful = true;
+            while (isGallopSuccessful && pointerToElementInFirstArray != temporaryEnd && pointerToElementInSecondArray != last)
+            {
+                minGallop -= (minGallop > 1);
+                
+                winsOfFirstArray = doMove(
+                                          pointerToElementInFirstArray, temporaryEnd, *pointerToElementInSecondArray,
+                                          placeToInsert, EBT_UPPER_BOUND, comp
+                                         );
+                if (pointerToElementInFirstArray == temporaryEnd)
+                {
+                    break;
+                }
+                *(placeToInsert++) = std::move(*(pointerToElementInSecondArray++));
+                
+                winsOfSecondArray = doMove(
+                                           pointerToElementInSecondArray, last, *pointerToElementInFirstArray,
+                                           placeToInsert, EBT_LOWER_BOUND, comp
+                                          );
+                if (pointerToElementInSecondArray == last)
+                {
+                    break;
+                }
+                *(placeToInsert++) = std::move(*(pointerToElementInFirstArray++));
+                
+                isGallopSuccessful = (winsOfFirstArray >= gallopSuccessLimit || winsOfSecondArray >= gallopSuccessLimit);
+                if (isGallopSuccessful)
+                {
+                    mergeState.getStats().onGallopSuccess();
+                }
+            }
+            if (!isGallopSuccessful)
+            {
+                ///penalty for leaving galloping mode
+                ++minGallop;
+            }
+        }
+        
+        mergeState.setMinGallop(minGallop);
+        mergeState.getStats().onMoves((middle - first) + (placeToInsert - first) + (temporaryEnd - pointerToElementInFirstArray));
+        std::move(pointerToElementInFirstArray, temporaryEnd, placeToInsert);
+    }
+
+    ///Mirror of mergeLeft: merges [first, middle) and [middle, last), using buffer of (last - middle) elements, from the end to the beginning
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void mergeRight(
+                    const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                    const RandomAccessIterator &last, Compare comp,
+                    const Parameters &params,
+                    MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                   )
+    {
+        
+#ifdef _USE_STD_INPLACE_MERGE
+        return void(std::inplace_merge(first, middle, last, comp));
+#endif
+        
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+        typedef typename MergeState<ValueType, Stats, Allocator>::BufferIterator BufferIterator;
+        
+        BufferIterator temporaryBegin = mergeState.moveToBuffer(middle, last);
+        BufferIterator temporaryEnd = temporaryBegin + (last - middle);
+        BufferIterator endOfSecondArray = temporaryEnd;
+        
+        RandomAccessIterator endOfFirstArray = middle;
+        RandomAccessIterator placeToInsert = last;
+        
+        size_t minGallop = mergeState.getMinGallop();
+        const size_t gallopSuccessLimit = params.getGallopSuccessLimit();
+        
+        while (endOfFirstArray != first && endOfSecondArray != temporaryBegin)
+        {
+            size_t winsOfFirstArray = 0;
+            size_t winsOfSecondArray = 0;
+            
+            mergeOneByOneBackward(
+                                  first, endOfFirstArray, temporaryBegin, endOfSecondArray,
+                                  placeToInsert, comp, minGallop, winsOfFirstArray, winsOfSecondArray,
+                                  typename IsCheapComparison<ValueType, Compare>::type()
+                                 );
+            if (endOfFirstArray == first || endOfSecondArray == temporaryBegin)
+            {
+                break;
+            }
+            
+            ++minGallop;
+            mergeState.getStats().onGallopEntry();
+            bool isGallopSuccessful = true;
+            while (isGallopSuccessful && endOfFirstArray != first && endOfSecondArray != temporaryBegin)
+            {
+                minGallop -= (minGallop > 1);
+                
+                winsOfSecondArray = doMoveBackward(
+                                                   temporaryBegin, endOfSecondArray, *(endOfFirstArray - 1),
+                                                   placeToInsert, EBT_LOWER_BOUND, comp
+                                                  );
+                if (endOfSecondArray == temporaryBegin)
+                {
+                    break;
+                }
+                *(--placeToInsert) = std::move(*(--endOfFirstArray));
+                
+                winsOfFirstArray = doMoveBackward(
+                                                  first, endOfFirstArray, *(endOfSecondArray - 1),
+                                                  placeToInsert, EBT_UPPER_BOUND, comp
+                                                 );
+                if (endOfFirstArray == first)
+                {
+                    break;
+                }
+                *(--placeToInsert) = std::move(*(--endOfSecondArray));
+                
+                isGallopSuccessful = (winsOfFirstArray >= gallopSuccessLimit || winsOfSecondArray >= gallopSuccessLimit);
+                if (isGallopSuccessful)
+                {
+                    mergeState.getStats().onGallopSuccess();
+                }
+            }
+            if (!isGallopSuccessful)
+            {
+                ///penalty for leaving galloping mode
+                ++minGallop;
+            }
+        }
+        
+        mergeState.setMinGallop(minGallop);
+        mergeState.getStats().onMoves((last - middle) + (last - placeToInsert) + (endOfSecondArray - temporaryBegin));
+        std::move_backward(temporaryBegin, endOfSecondArray, placeToInsert);
+    }
+    
+
+    ///Elements of the run [first, middle), which are not greater than *middle, and elements of the run [middle, last), which are not less than *(middle - 1),
+    ///are already in place; moves first and last, so that they are skipped
+    ///Returns false, if runs are already in order and nothing is left to merge
+    template <class RandomAccessIterator, class Compare>
+    bool trimRunsToMerge(RandomAccessIterator &first, const RandomAccessIterator &middle, RandomAccessIterator &last, Compare comp)
+    {
+        if (first == middle || middle == last)
+        {
+            return false;
+        }
+        first = gallop(*middle, first, middle, 0, EBT_UPPER_BOUND, comp);
+        if (first == middle)
+        {
+            return false;
+        }
+        last = gallop(*(middle - 1), middle, last, (last - middle) - 1, EBT_LOWER_BOUND, comp);
+        return true;
+    }
+    
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void mergeWithRotations(
+                            const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                            const RandomAccessIterator &last, Compare comp,
+                            const Parameters &params,
+                            MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                           );
+    
+    ///Merges [first, middle) and [middle, last), without counting it as a separate merge in stats
+    ///Only the parts of the runs, which are not in place yet (see trimRunsToMerge), are merged
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void mergeTrimmed(
+                      const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                      const RandomAccessIterator &last, Compare comp,
+                      const Parameters &params,
+                      MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                     )
+    {
+        RandomAccessIterator firstToMerge = first;
+        RandomAccessIterator lastToMerge = last;
+        if (!trimRunsToMerge(firstToMerge, middle, lastToMerge, comp))
+        {
+            return;
+        }
+        
+        size_t sizeOfFirst = middle - firstToMerge;
+        size_t sizeOfSecond = lastToMerge - middle;
+        if (std::min(sizeOfFirst, sizeOfSecond) > mergeState.getMaxBufferSize())
+        {
+            mergeWithRotations(firstToMerge, middle, lastToMerge, comp, params, mergeState);
+        }
+        else if (sizeOfFirst <= sizeOfSecond)
+        {
+            mergeLeft(firstToMerge, middle, lastToMerge, comp, params, mergeState);
+        }
+        else
+        {
+            mergeRight(firstToMerge, middle, lastToMerge, comp, params, mergeState);
+        }
+    }
+    
+    ///Merge of runs, which are both larger than maxBufferSize of mergeState (it is at least 1)
+    ///The middle element of the larger run is placed to its final position in the other run by binary search and std::rotate,
+    ///which splits the merge into two smaller ones; they are done with buffer, when it is large enough, and galloping as usual
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void mergeWithRotations(
+                            const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                            const RandomAccessIterator &last, Compare comp,
+                            const Parameters &params,
+                            MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+                           )
+    {
+        RandomAccessIterator firstCut, secondCut;
+        if (middle - first > last - middle)
+        {
+            firstCut = first + (middle - first) / 2;
+            secondCut = std::lower_bound(middle, last, *firstCut, comp);
+        }
+        else
+        {
+            secondCut = middle + (last - middle) / 2;
+            firstCut = std::upper_bound(first, middle, *secondCut, comp);
+        }
+        mergeState.getStats().onMoves(secondCut - firstCut);
+        RandomAccessIterator newMiddle = std::rotate(firstCut, middle, secondCut);
+        
+        mergeTrimmed(first, firstCut, newMiddle, comp, params, mergeState);
+        mergeTrimmed(newMiddle, secondCut, last, comp, params, mergeState);
+    }
+    
+    ///Merges [first, middle) and [middle, last)
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void merge(
+               const RandomAccessIterator &first, const RandomAccessIterator &middle,
+               const RandomAccessIterator &last, Compare comp,
+               const Parameters &params,
+               MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState
+              )
+    {   
+        mergeState.getStats().onMerge(last - first);
+        mergeTrimmed(first, middle, last, comp, params, mergeState);
+    }
+
+
+    ///Takes currentElement iterator and stack
+    ///Pushes next Run into stack
+    ///After procedure, currentElement iterator points to the first element of next run or to the last element
+    template<class RandomAccessIterator, class Compare, class Stats>
     void pushNextRun(
                      RandomAccessIterator &currentElement, const RandomAccessIterator &last,
-                     StackOfRuns<RandomAccessIterator> &runs, unsigned int minRun, Compare comp
+                     StackOfRuns<RandomAccessIterator> &runs, unsigned int minRun, Compare comp, Stats &stats
                     )
     {
-            Run<RandomAccessIterator> nextRun(currentElement++, 1u);
+            Run nextRun(runs.getOffset(currentElement++), 1u);
             
             if (currentElement != last)
             {
@@ -375,103 +1323,320 @@ namespace TimSortFunctionsAndClasses
                 
                 if (compareResult)
                 {
-                    std::reverse(nextRun.getFirstIterator(), nextRun.getLastIterator());
+                    stats.onMoves(nextRun.getSize() / 2 * 3);
+                    std::reverse(runs.getFirstIterator(nextRun), runs.getLastIterator(nextRun));
                 }
+                stats.onNaturalRun(nextRun.getSize());
                 
                 if (currentElement != last && nextRun.getSize() < minRun)
                 {
-                    unsigned int sizeDifference = std::min(static_cast<unsigned int> (last - currentElement), minRun - nextRun.getSize());
+                    size_t sizeDifference = std::min(static_cast<size_t> (last - currentElement), minRun - nextRun.getSize());
                     currentElement += sizeDifference;
                     nextRun.addToSize(sizeDifference);
-                    insertionSort(nextRun.getFirstIterator(), nextRun.getLastIterator(), comp, nextRun.getSize() - sizeDifference);
+                    insertionSort(runs.getFirstIterator(nextRun), runs.getLastIterator(nextRun), comp, nextRun.getSize() - sizeDifference, stats);
                 }
             }
+            else
+            {
+                stats.onNaturalRun(1u);
+            }
             
+            nextRun.setPower(runs.getNodePowerBefore(nextRun));
             runs.push(nextRun);
     }
     
-    template <class RandomAccessIterator, class Compare>
+    template<class RandomAccessIterator, class Compare>
+    void pushNextRun(
+                     RandomAccessIterator &currentElement, const RandomAccessIterator &last,
+                     StackOfRuns<RandomAccessIterator> &runs, unsigned int minRun, Compare comp
+                    )
+    {
+        NoTimSortStats stats;
+        pushNextRun(currentElement, last, runs, minRun, comp, stats);
+    }
+    
+    template <class RandomAccessIterator, class Parameters>
+    MergeActionType getMergeAction(const StackOfRuns<RandomAccessIterator> &runs, const Parameters &params, RunSizesMergeDecision)
+    {
+        if (runs.size() != 2u)
+        {
+            return params.getMergeAction(runs[-1].getSize(), runs[-2].getSize(), runs[-3].getSize());
+        }
+        else
+        {
+            return params.getMergeAction(runs[-1].getSize(), runs[-2].getSize());
+        }
+    }
+    
+    template <class RandomAccessIterator, class Parameters>
+    MergeActionType getMergeAction(const StackOfRuns<RandomAccessIterator> &runs, const Parameters &params, NodePowerMergeDecision)
+    {
+        return params.getMergeActionByPowers(runs[-1].getPower(), runs[-2].getPower());
+    }
+    
+    ///Returns index of the second run of the next merge, which stack needs (-1 for YX merge, -2 for ZY merge), or 0, if no merge is needed
+    ///Merges are chosen by params, but when stack is full, next run can't be pushed, so parameters, which keep too many runs, are overruled
+    template <class RandomAccessIterator, class Parameters>
+    int getNextMerge(const StackOfRuns<RandomAccessIterator> &runs, const Parameters &params)
+    {
+        if (runs.size() < 2)
+        {
+            return 0;
+        }
+        switch (getMergeAction(runs, params, typename Parameters::MergeDecisionType()))
+        {
+            case MERGE_YX:
+                return -1;
+            case MERGE_ZY:
+                return -2;
+            case MERGE_NOTHING:
+                return (runs.isFull() ? -1 : 0);
+            default:
+                throw "Bad timSort parameters\n";
+        }
+    }
+    
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
     void processCurrentStackOfRuns(
                                    StackOfRuns<RandomAccessIterator> &runs,
-                                   const ITimSortParameters* const params, Compare comp = Compare()
+                                   const Parameters &params,
+                                   MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState,
+                                   Compare comp = Compare()
                                   )
     {
+        for (int indexOfSecondMergingElement = getNextMerge(runs, params); indexOfSecondMergingElement != 0;
+             indexOfSecondMergingElement = getNextMerge(runs, params))
+        {
+            runs.mergeRuns(indexOfSecondMergingElement, comp, params, mergeState);
+        }
+    }
+    
+    
+    ///Memory, which timSort needs: stack of runs and merge buffer, and observer of timSort calls (e.g. TimSortStats)
+    ///Pass the same workspace to consecutive timSort calls to avoid allocations on every call
+    ///Merge buffer is allocated by allocator; stack of runs doesn't allocate memory
+    template<
+             class RandomAccessIterator, class Stats = NoTimSortStats,
+             class Allocator = std::allocator<typename std::iterator_traits<RandomAccessIterator>::value_type>
+            >
+    class TimSortWorkspace
+    {
+        StackOfRuns<RandomAccessIterator> runs;
+        
+        MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> mergeState;
+    public:
+        explicit TimSortWorkspace(const Allocator &allocator = Allocator()) : mergeState(allocator)
+        {
+        }
+        
+        StackOfRuns<RandomAccessIterator> &getRuns()
+        {
+            return runs;
+        }
+        
+        MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &getMergeState()
+        {
+            return mergeState;
+        }
+        
+        ///Observer of the last timSort call
+        Stats &getStats()
+        {
+            return mergeState.getStats();
+        }
+        
+        ///Limits merge buffer (the only memory of timSort, which is proportional to the number of elements) by maxBufferBytes, but to at least one element
+        ///Merges of runs, which don't fit, are split by rotations, so they make more moves; default limit is infinite
+        void setMaxBufferBytes(size_t maxBufferBytes)
+        {
+            typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+            mergeState.setMaxBufferSize(std::max<size_t>(1u, maxBufferBytes / sizeof(ValueType)));
+        }
+    };
+    
+    
+    ///Parameters are either ITimSortParameters (then their functions are virtual) or a policy like TimSortPolicyDefault (then they are static)
+    ///With observer other than NoTimSortStats, comparisons are counted by CountingComparator and phases are timed
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats, class Allocator>
+    void sortWithParameters(
+                            RandomAccessIterator first, RandomAccessIterator last,
+                            const Parameters &params, Compare comp,
+                            TimSortWorkspace<RandomAccessIterator, Stats, Allocator> &workspace
+                           )
+    {
+        size_t numberOfElements = last - first;
+        unsigned int minRun = params.getMinRun(numberOfElements);
+
+        StackOfRuns<RandomAccessIterator> &runs = workspace.getRuns();
+        runs.reset(first, numberOfElements);
+        workspace.getMergeState().setMinGallop(params.getMergeStupidIterationsLimit());
+        
+        Stats &stats = workspace.getStats();
+        stats.reset();
+        auto observedComp = stats.wrapComparator(comp);
+        
+        for (RandomAccessIterator currentElement = first; currentElement != last;)
+        {   
+            stats.switchPhase(PHASE_RUN_DETECTION);
+            pushNextRun(currentElement, last, runs, minRun, observedComp, stats);
+            stats.switchPhase(PHASE_MERGE);
+            processCurrentStackOfRuns(runs, params, workspace.getMergeState(), observedComp);
+        }
+        
+        stats.switchPhase(PHASE_MERGE);
         while (runs.size() > 1)
         {
-            MergeActionType action;
-            
-            if (runs.size() != 2u)
-            {
-                action = params->getMergeAction(runs[-1].getSize(), runs[-2].getSize(), runs[-3].getSize());
-            }
-            else
-            {
-                action = params->getMergeAction(runs[-1].getSize(), runs[-2].getSize());
-            }
-            
-            switch (action)
-            {
-                case MERGE_YX:
-                    runs.mergeRuns(-1, comp, params);
-                    break;
-                case MERGE_ZY:
-                    runs.mergeRuns(-2, comp, params);
-                    break;
-                case MERGE_NOTHING:
-                    return;
-                default:
-                    throw "Bad timSort parameters\n";
-            }
+            runs.mergeRuns(-1, observedComp, params, workspace.getMergeState());
         }
+        stats.switchPhase(PHASE_NONE);
+    }
+    
+    
+    ///Pointers and iterators of std::vector (except std::vector<bool>): elements are contiguous, so the range can be sorted by pointers
+    template<class RandomAccessIterator>
+    class IsContiguousIterator : public std::integral_constant<
+                                                               bool,
+                                                               std::is_pointer<RandomAccessIterator>::value ||
+                                                               (
+                                                                std::is_same<
+                                                                             RandomAccessIterator,
+                                                                             typename std::vector<typename std::iterator_traits<RandomAccessIterator>::value_type>::iterator
+                                                                            >::value &&
+                                                                !std::is_same<typename std::iterator_traits<RandomAccessIterator>::value_type, bool>::value
+                                                               )
+                                                              >
+    {
+    };
+    
+    ///Sorts with workspace of its own and copies observer of the call to stats
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats>
+    void sortWithNewWorkspace(
+                              RandomAccessIterator first, RandomAccessIterator last, const Parameters &params, Compare comp, Stats &stats,
+                              std::false_type
+                             )
+    {
+        TimSortWorkspace<RandomAccessIterator, Stats> workspace;
+        sortWithParameters(first, last, params, comp, workspace);
+        stats = workspace.getStats();
+    }
+    
+    ///Iterators are unwrapped to pointers, so all merges, gallops and bulk moves work on pointers,
+    ///and moves of trivially copyable elements become memmove calls in the standard algorithms
+    template <class RandomAccessIterator, class Compare, class Parameters, class Stats>
+    void sortWithNewWorkspace(
+                              RandomAccessIterator first, RandomAccessIterator last, const Parameters &params, Compare comp, Stats &stats,
+                              std::true_type
+                             )
+    {
+        if (first == last)
+        {
+            stats.reset();
+            return;
+        }
+        typename std::iterator_traits<RandomAccessIterator>::value_type *pointerToFirst = std::addressof(*first);
+        sortWithNewWorkspace(pointerToFirst, pointerToFirst + (last - first), params, comp, stats, std::false_type());
     }
 };
 
 
+template <class RandomAccessIterator, class Compare, class Stats, class Allocator>
+void timSort(
+             RandomAccessIterator first, RandomAccessIterator last, 
+             const TimSortFunctionsAndClasses::ITimSortParameters* const params, Compare comp,
+             TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator, Stats, Allocator> &workspace
+            ) // comp(a, b) <=> a < b;
+{    
+    TimSortFunctionsAndClasses::sortWithParameters(first, last, *params, comp, workspace);
+}
+
 template <class RandomAccessIterator, class Compare>
 void timSort(
              RandomAccessIterator first, RandomAccessIterator last, 
              const TimSortFunctionsAndClasses::ITimSortParameters* const params, Compare comp
             ) // comp(a, b) <=> a < b;
-{    
-    unsigned int numberOfElements = last - first;
-    unsigned int minRun = params->getMinRun(numberOfElements);
+{
+    TimSortFunctionsAndClasses::NoTimSortStats stats;
+    TimSortFunctionsAndClasses::sortWithNewWorkspace(
+                                                     first, last, *params, comp, stats,
+                                                     typename TimSortFunctionsAndClasses::IsContiguousIterator<RandomAccessIterator>::type()
+                                                    );
+}
 
-    TimSortFunctionsAndClasses::StackOfRuns<RandomAccessIterator> runs;
-    
-#ifdef _DEBUG_CNT_OPERATIONS
-    mergeOperationsCnt = 0;
-    insertionSortIterationsCnt = 0;
-#endif
-    
-    for (RandomAccessIterator currentElement = first; currentElement != last;)
-    {   
-        TimSortFunctionsAndClasses::pushNextRun(currentElement, last, runs, minRun, comp);
-        TimSortFunctionsAndClasses::processCurrentStackOfRuns(runs, params, comp);
-    }
-    
-#ifdef _DEBUG_CNT_OPERATIONS
-    printf("diffMergeOperations: %lf\n", 1.0 * mergeOperationsCnt / numberOfElements);
-    printf("diffInsertSortOperations: %lf\n", 1.0 * insertionSortIterationsCnt / numberOfElements);
-#endif
-    
-    while (runs.size() != 1)
-    {
-        runs.mergeRuns(-1, comp, params);
-    }
+///Policy is a class with static functions like TimSortPolicyDefault: timSort<Policy>(first, last, comp, workspace)
+template <class Policy, class RandomAccessIterator, class Compare, class Stats, class Allocator>
+void timSort(
+             RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+             TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator, Stats, Allocator> &workspace
+            ) /// comp(a, b) <=> a < b;
+{
+    Policy policy;
+    TimSortFunctionsAndClasses::sortWithParameters(first, last, policy, comp, workspace);
+}
+
+///Statistics of the call are written to stats
+template <class Policy, class RandomAccessIterator, class Compare>
+void timSort(
+             RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+             TimSortFunctionsAndClasses::TimSortStats &stats
+            ) /// comp(a, b) <=> a < b;
+{
+    Policy policy;
+    TimSortFunctionsAndClasses::sortWithNewWorkspace(
+                                                     first, last, policy, comp, stats,
+                                                     typename TimSortFunctionsAndClasses::IsContiguousIterator<RandomAccessIterator>::type()
+                                                    );
+}
+
+template <class Policy, class RandomAccessIterator, class Compare>
+void timSort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) /// comp(a, b) <=> a < b;
+{
+    Policy policy;
+    TimSortFunctionsAndClasses::NoTimSortStats stats;
+    TimSortFunctionsAndClasses::sortWithNewWorkspace(
+                                                     first, last, policy, comp, stats,
+                                                     typename TimSortFunctionsAndClasses::IsContiguousIterator<RandomAccessIterator>::type()
+                                                    );
+}
+
+template <class RandomAccessIterator, class Compare, class Stats, class Allocator>
+void timSort(
+             RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+             TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator, Stats, Allocator> &workspace
+            ) /// comp(a, b) <=> a < b;
+{
+    timSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(first, last, comp, workspace);
+}
+
+template <class RandomAccessIterator, class Compare>
+void timSort(
+             RandomAccessIterator first, RandomAccessIterator last, Compare comp,
+             TimSortFunctionsAndClasses::TimSortStats &stats
+            ) /// comp(a, b) <=> a < b;
+{
+    timSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(first, last, comp, stats);
 }
 
 template <class RandomAccessIterator, class Compare>
 void timSort(RandomAccessIterator first, RandomAccessIterator last, Compare comp) /// comp(a, b) <=> a < b;
 {
-    TimSortFunctionsAndClasses::TimSortParametersDefault params;
-    timSort(first, last, &params, comp);
+    timSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(first, last, comp);
 }
 
+#if __cplusplus >= 201703L
+///Merge buffer is allocated from resource, e.g. std::pmr::monotonic_buffer_resource of the request; stack of runs is a fixed-size array of the workspace
+template <class RandomAccessIterator, class Compare>
+void timSort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, std::pmr::memory_resource *resource) /// comp(a, b) <=> a < b;
+{
+    typedef std::pmr::polymorphic_allocator<typename std::iterator_traits<RandomAccessIterator>::value_type> Allocator;
+    TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator, TimSortFunctionsAndClasses::NoTimSortStats, Allocator> workspace{Allocator(resource)};
+    timSort(first, last, comp, workspace);
+}
+#endif
+
 template<class RandomAccessIterator>
 void timSort(RandomAccessIterator first, RandomAccessIterator last)
 {
-    TimSortFunctionsAndClasses::TimSortParametersDefault params;
-    timSort(first, last, &params, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+    timSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(first, last, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,149 @@
+#ifndef _TIM_SORT_BY_KEY
+#define _TIM_SORT_BY_KEY
+
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "timsort.h"
+
+///timSort for expensive comparators and large elements: keys are extracted once per element or indices are sorted instead of elements,
+///then elements are permuted in place
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Compares (key, index) pairs by keys only, so stable sort of pairs keeps equal keys in the order of indices
+    template<class KeyCompare>
+    class KeyOfPairComparator
+    {
+        KeyCompare keyComp;
+    public:
+        KeyOfPairComparator(KeyCompare keyComp) : keyComp(keyComp)
+        {
+        }
+
+        template<class PairType>
+        bool operator()(const PairType &first, const PairType &second) const
+        {
+            return keyComp(first.first, second.first);
+        }
+    };
+
+    template<class KeyType, class IndexType, class KeyCompare>
+    class IsCheapComparison<std::pair<KeyType, IndexType>, KeyOfPairComparator<KeyCompare> > : public IsCheapComparison<KeyType, KeyCompare>
+    {
+    };
+
+    ///Compares indices by elements of [first, ...), which they point to
+    template<class RandomAccessIterator, class Compare>
+    class IndexComparator
+    {
+        RandomAccessIterator first;
+
+        Compare comp;
+    public:
+        IndexComparator(const RandomAccessIterator &first, Compare comp) : first(first), comp(comp)
+        {
+        }
+
+        template<class IndexType>
+        bool operator()(IndexType firstIndex, IndexType secondIndex) const
+        {
+            return comp(first[firstIndex], first[secondIndex]);
+        }
+    };
+};
+
+
+///Reorders [first, last) in place, so that element number i becomes the element, which was number permutation[i]
+///Every cycle of permutation is followed once, so each element is moved once (plus one move per cycle) and O(n) bits of memory are used
+template<class RandomAccessIterator, class IndexType>
+void applyPermutation(RandomAccessIterator first, RandomAccessIterator last, const std::vector<IndexType> &permutation)
+{
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+    size_t numberOfElements = last - first;
+    std::vector<bool> isPlaced(numberOfElements, false);
+
+    for (size_t cycleStart = 0; cycleStart < numberOfElements; ++cycleStart)
+    {
+        if (isPlaced[cycleStart] || static_cast<size_t>(permutation[cycleStart]) == cycleStart)
+        {
+            continue;
+        }
+        ValueType cycleStartElement = std::move(first[cycleStart]);
+        size_t current = cycleStart;
+        while (static_cast<size_t>(permutation[current]) != cycleStart)
+        {
+            first[current] = std::move(first[permutation[current]]);
+            isPlaced[current] = true;
+            current = permutation[current];
+        }
+        first[current] = std::move(cycleStartElement);
+        isPlaced[current] = true;
+    }
+}
+
+///Returns stable permutation, which sorts [first, last): element number i of sorted range is first[result[i]]
+///Only indices are moved during sort, so it is useful for large elements; IndexType may be 32-bit to halve memory traffic
+template<class IndexType, class RandomAccessIterator, class Compare>
+std::vector<IndexType> timSortIndices(RandomAccessIterator first, RandomAccessIterator last, Compare comp) // comp(a, b) <=> a < b;
+{
+    size_t numberOfElements = last - first;
+    if (numberOfElements > 0 && static_cast<size_t>(static_cast<IndexType>(numberOfElements - 1)) != numberOfElements - 1)
+    {
+        throw "Too many elements for this index type\n";
+    }
+
+    std::vector<IndexType> indices(numberOfElements);
+    for (size_t i = 0; i < numberOfElements; ++i)
+    {
+        indices[i] = static_cast<IndexType>(i);
+    }
+    timSort(indices.begin(), indices.end(), TimSortFunctionsAndClasses::IndexComparator<RandomAccessIterator, Compare>(first, comp));
+    return indices;
+}
+
+template<class IndexType, class RandomAccessIterator>
+std::vector<IndexType> timSortIndices(RandomAccessIterator first, RandomAccessIterator last)
+{
+    return timSortIndices<IndexType>(first, last, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+}
+
+
+///Sorts [first, last) stably in the order of keyComp(keyFn(a), keyFn(b)); keyFn is called exactly once for each element
+///Elements are gathered into a buffer in sorted order, since sequential writes are faster than following cycles with applyPermutation
+template<class RandomAccessIterator, class KeyFunction, class KeyCompare>
+void timSortByKey(RandomAccessIterator first, RandomAccessIterator last, KeyFunction keyFn, KeyCompare keyComp) // keyComp(a, b) <=> a < b;
+{
+    typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+    typedef typename std::decay<decltype(keyFn(*first))>::type KeyType;
+
+    size_t numberOfElements = last - first;
+    std::vector<std::pair<KeyType, size_t> > keys;
+    keys.reserve(numberOfElements);
+    for (size_t i = 0; i < numberOfElements; ++i)
+    {
+        keys.push_back(std::pair<KeyType, size_t>(keyFn(first[i]), i));
+    }
+
+    timSort(keys.begin(), keys.end(), TimSortFunctionsAndClasses::KeyOfPairComparator<KeyCompare>(keyComp));
+
+    std::vector<ValueType> sortedElements;
+    sortedElements.reserve(numberOfElements);
+    for (size_t i = 0; i < numberOfElements; ++i)
+    {
+        sortedElements.push_back(std::move(first[keys[i].second]));
+    }
+    std::move(sortedElements.begin(), sortedElements.end(), first);
+}
+
+template<class RandomAccessIterator, class KeyFunction>
+void timSortByKey(RandomAccessIterator first, RandomAccessIterator last, KeyFunction keyFn)
+{
+    typedef typename std::decay<decltype(keyFn(*first))>::type KeyType;
+    timSortByKey(first, last, keyFn, std::less<KeyType>());
+}
+
+#endif
@@ -0,0 +1,343 @@
+#ifndef _TIM_SORT_EXTERNAL
+#define _TIM_SORT_EXTERNAL
+
+#include <cstdio>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "timsort.h"
+
+///Sort of binary files of fixed-size records, which do not fit into memory:
+///memory-sized chunks are sorted with timSort and spilled to temporary files, then temporary files are merged with k-way merge
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Reads and writes are done by blocks of at least this size, so disks are accessed sequentially
+    const size_t MIN_EXTERNAL_BUFFER_SIZE_IN_BYTES = 1u << 20;
+
+    ///Not more than this number of files are merged at once (and opened at once)
+    const size_t MAX_EXTERNAL_MERGE_FAN_IN = 256;
+
+
+    inline std::FILE *openFile(const std::string &fileName, const char *mode)
+    {
+        std::FILE *file = std::fopen(fileName.c_str(), mode);
+        if (!file)
+        {
+            throw "Can't open file\n";
+        }
+        return file;
+    }
+
+    class FileCloser
+    {
+    public:
+        void operator()(std::FILE *file) const
+        {
+            std::fclose(file);
+        }
+    };
+
+    ///Reads records from file by large blocks
+    template<class Record>
+    class RecordReader
+    {
+        std::FILE *file;
+
+        std::vector<Record> buffer;
+
+        size_t position;
+
+        size_t size;
+
+        RecordReader(const RecordReader &);
+
+        RecordReader &operator=(const RecordReader &);
+    public:
+        RecordReader(const std::string &fileName, size_t bufferSize) : file(openFile(fileName, "rb")), buffer(std::max<size_t>(bufferSize, 1u)), position(0), size(0)
+        {
+            std::setvbuf(file, 0, _IONBF, 0);
+        }
+
+        ~RecordReader()
+        {
+            std::fclose(file);
+        }
+
+        ///Returns false, if all records are read
+        bool hasCurrent()
+        {
+            if (position == size)
+            {
+                size = std::fread(buffer.data(), sizeof(Record), buffer.size(), file);
+                position = 0;
+                if (size == 0 && std::ferror(file))
+                {
+                    throw "Can't read file\n";
+                }
+            }
+            return position != size;
+        }
+
+        const Record &getCurrent() const
+        {
+            return buffer[position];
+        }
+
+        void next()
+        {
+            ++position;
+        }
+    };
+
+    ///Writes records to file by large blocks
+    template<class Record>
+    class RecordWriter
+    {
+        std::FILE *file;
+
+        std::vector<Record> buffer;
+
+        size_t size;
+
+        RecordWriter(const RecordWriter &);
+
+        RecordWriter &operator=(const RecordWriter &);
+    public:
+        RecordWriter(const std::string &fileName, size_t bufferSize) : file(openFile(fileName, "wb")), buffer(std::max<size_t>(bufferSize, 1u)), size(0)
+        {
+            std::setvbuf(file, 0, _IONBF, 0);
+        }
+
+        ~RecordWriter()
+        {
+            std::fclose(file);
+        }
+
+        void write(const Record &record)
+        {
+            buffer[size++] = record;
+            if (size == buffer.size())
+            {
+                flush();
+            }
+        }
+
+        void flush()
+        {
+            if (std::fwrite(buffer.data(), sizeof(Record), size, file) != size)
+            {
+                throw "Can't write file\n";
+            }
+            size = 0;
+        }
+    };
+
+
+    ///Stable k-way merge of sorted files [firstFileName, lastFileName) into outputFileName; ties are resolved in favour of the earlier file
+    ///Each file gets a read buffer of bufferSize records
+    template<class Record, class Compare>
+    void mergeSortedFiles(
+                          std::vector<std::string>::const_iterator firstFileName, std::vector<std::string>::const_iterator lastFileName,
+                          const std::string &outputFileName, size_t bufferSize, Compare comp
+                         )
+    {
+        std::vector<std::unique_ptr<RecordReader<Record> > > readers;
+        for (std::vector<std::string>::const_iterator fileName = firstFileName; fileName != lastFileName; ++fileName)
+        {
+            readers.push_back(std::unique_ptr<RecordReader<Record> >(new RecordReader<Record>(*fileName, bufferSize)));
+        }
+
+        RecordWriter<Record> writer(outputFileName, bufferSize);
+
+        ///heap of indices of readers, the top one has the least current record
+        std::vector<size_t> heap;
+        auto isAfter = [&](size_t first, size_t second)
+        {
+            const Record &firstRecord = readers[first]->getCurrent();
+            const Record &secondRecord = readers[second]->getCurrent();
+            return comp(secondRecord, firstRecord) || (!comp(firstRecord, secondRecord) && first > second);
+        };
+
+        for (size_t i = 0; i < readers.size(); ++i)
+        {
+            if (readers[i]->hasCurrent())
+            {
+                heap.push_back(i);
+            }
+        }
+        std::make_heap(heap.begin(), heap.end(), isAfter);
+
+        while (!heap.empty())
+        {
+            std::pop_heap(heap.begin(), heap.end(), isAfter);
+            RecordReader<Record> &reader = *readers[heap.back()];
+            writer.write(reader.getCurrent());
+            reader.next();
+            if (reader.hasCurrent())
+            {
+                std::push_heap(heap.begin(), heap.end(), isAfter);
+            }
+            else
+            {
+                heap.pop_back();
+            }
+        }
+        writer.flush();
+    }
+
+    ///Temporary files of externalTimSort; files, which are still listed, are removed in destructor,
+    ///so they don't stay on disk, if sort fails (e.g. I/O error or exception of comparator)
+    class TemporaryFiles
+    {
+        std::vector<std::string> fileNames;
+
+        TemporaryFiles(const TemporaryFiles &);
+
+        TemporaryFiles &operator=(const TemporaryFiles &);
+    public:
+        TemporaryFiles()
+        {
+        }
+
+        ~TemporaryFiles()
+        {
+            removeFiles(0, fileNames.size());
+        }
+
+        const std::vector<std::string> &getFileNames() const
+        {
+            return fileNames;
+        }
+
+        size_t size() const
+        {
+            return fileNames.size();
+        }
+
+        ///File shall be added before it is created, so it is removed even if its creation fails
+        void add(const std::string &fileName)
+        {
+            fileNames.push_back(fileName);
+        }
+
+        ///Removes files [begin, end) of the list; their names are cleared, so they are not removed again
+        void removeFiles(size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+            {
+                if (!fileNames[i].empty())
+                {
+                    std::remove(fileNames[i].c_str());
+                    fileNames[i].clear();
+                }
+            }
+        }
+
+        void swap(TemporaryFiles &other)
+        {
+            fileNames.swap(other.fileNames);
+        }
+    };
+};
+
+
+///Sorts binary file of records of type Record (trivially copyable, stored as they are in memory) into outputFileName,
+///using about memoryLimitInBytes of memory
+///Chunks of 2/3 of memory are sorted with timSort (merge buffer is limited by the rest, see setMaxBufferBytes) and written to temporary files
+///temporaryFilesPrefix + number (by default temporary files are created next to output file), which are merged afterwards;
+///if there are more than MAX_EXTERNAL_MERGE_FAN_IN of them, they are merged in several passes
+///Sort is stable
+template<class Record, class Compare>
+void externalTimSort(
+                     const std::string &inputFileName, const std::string &outputFileName,
+                     size_t memoryLimitInBytes, Compare comp, std::string temporaryFilesPrefix = ""
+                    ) // comp(a, b) <=> a < b;
+{
+    using namespace TimSortFunctionsAndClasses;
+    static_assert(std::is_trivially_copyable<Record>::value, "externalTimSort can sort only trivially copyable records");
+
+    if (temporaryFilesPrefix.empty())
+    {
+        temporaryFilesPrefix = outputFileName + ".run";
+    }
+    size_t memoryLimit = std::max(memoryLimitInBytes / sizeof(Record), MIN_EXTERNAL_BUFFER_SIZE_IN_BYTES / sizeof(Record) + 1);
+    size_t chunkSize = memoryLimit / 3 * 2;
+
+    TemporaryFiles runFiles;
+    bool isOutputWritten = false;
+    {
+        std::unique_ptr<std::FILE, FileCloser> input(openFile(inputFileName, "rb"));
+        std::vector<Record> chunk(chunkSize);
+        TimSortWorkspace<typename std::vector<Record>::iterator> workspace;
+        workspace.setMaxBufferBytes((memoryLimit - chunkSize) * sizeof(Record));
+
+        size_t numberOfRecords;
+        while ((numberOfRecords = std::fread(chunk.data(), sizeof(Record), chunkSize, input.get())) > 0)
+        {
+            timSort(chunk.begin(), chunk.begin() + numberOfRecords, comp, workspace);
+
+            ///the only chunk is written to output file at once
+            isOutputWritten = (runFiles.size() == 0 && numberOfRecords < chunkSize);
+            if (!isOutputWritten)
+            {
+                runFiles.add(temporaryFilesPrefix + std::to_string(runFiles.size()));
+            }
+            std::FILE *run = openFile(isOutputWritten ? outputFileName : runFiles.getFileNames().back(), "wb");
+            size_t numberOfWrittenRecords = std::fwrite(chunk.data(), sizeof(Record), numberOfRecords, run);
+            std::fclose(run);
+            if (numberOfWrittenRecords != numberOfRecords)
+            {
+                throw "Can't write file\n";
+            }
+        }
+        if (std::ferror(input.get()))
+        {
+            throw "Can't read file\n";
+        }
+    }
+
+    if (isOutputWritten)
+    {
+        return;
+    }
+    if (runFiles.size() == 0)
+    {
+        std::fclose(openFile(outputFileName, "wb"));
+        return;
+    }
+
+    size_t maxFanIn = std::min(MAX_EXTERNAL_MERGE_FAN_IN, std::max<size_t>(2u, memoryLimit / (MIN_EXTERNAL_BUFFER_SIZE_IN_BYTES / sizeof(Record) + 1) - 1));
+    for (size_t pass = 0; runFiles.size() > maxFanIn; ++pass)
+    {
+        TemporaryFiles mergedRunFiles;
+        for (size_t begin = 0; begin < runFiles.size(); begin += maxFanIn)
+        {
+            size_t end = std::min(begin + maxFanIn, runFiles.size());
+            mergedRunFiles.add(temporaryFilesPrefix + std::to_string(pass) + "." + std::to_string(mergedRunFiles.size()));
+            mergeSortedFiles<Record>(
+                                     runFiles.getFileNames().begin() + begin, runFiles.getFileNames().begin() + end,
+                                     mergedRunFiles.getFileNames().back(), memoryLimit / (end - begin + 1), comp
+                                    );
+            runFiles.removeFiles(begin, end);
+        }
+        runFiles.swap(mergedRunFiles);
+    }
+
+    mergeSortedFiles<Record>(
+                             runFiles.getFileNames().begin(), runFiles.getFileNames().end(),
+                             outputFileName, memoryLimit / (runFiles.size() + 1), comp
+                            );
+}
+
+template<class Record>
+void externalTimSort(const std::string &inputFileName, const std::string &outputFileName, size_t memoryLimitInBytes)
+{
+    externalTimSort<Record>(inputFileName, outputFileName, memoryLimitInBytes, std::less<Record>());
+}
+
+#endif
@@ -0,0 +1,255 @@
+#ifndef _TIM_SORT_HYBRID
+#define _TIM_SORT_HYBRID
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <vector>
+#include "timsort.h"
+
+///timSort with integral keys, which sorts stretches without long natural runs by LSD radix sort instead of insertion sort and merges
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Stretches of short runs, which are shorter than this, are sorted as in timSort
+    const size_t HYBRID_RADIX_SORT_MIN_SIZE = 1024;
+
+    const unsigned int RADIX_SORT_BITS = 8;
+
+    const unsigned int RADIX_SORT_BUCKETS = 1u << RADIX_SORT_BITS;
+
+    class IdentityKey
+    {
+    public:
+        template<class ValueType>
+        const ValueType &operator()(const ValueType &value) const
+        {
+            return value;
+        }
+    };
+
+    ///Compares elements by their keys
+    template<class KeyFunction>
+    class KeyFunctionComparator
+    {
+        KeyFunction keyFn;
+    public:
+        KeyFunctionComparator(KeyFunction keyFn) : keyFn(keyFn)
+        {
+        }
+
+        template<class ValueType>
+        bool operator()(const ValueType &first, const ValueType &second) const
+        {
+            return keyFn(first) < keyFn(second);
+        }
+    };
+
+    ///Maps integral key to unsigned one of the same size, which has the same order
+    template<class KeyType>
+    typename std::make_unsigned<KeyType>::type getRadixKey(KeyType key)
+    {
+        typedef typename std::make_unsigned<KeyType>::type UnsignedKeyType;
+        UnsignedKeyType signBit = (std::is_signed<KeyType>::value ? UnsignedKeyType(1) << (std::numeric_limits<UnsignedKeyType>::digits - 1) : 0);
+        return static_cast<UnsignedKeyType>(key) ^ signBit;
+    }
+
+    ///Stable LSD radix sort of [first, last) by integral keys keyFn(element), one byte per pass
+    ///Elements are moved into the buffer of mergeState, then go back and forth between it and the range; passes, in which all keys have equal byte, are skipped
+    template<class RandomAccessIterator, class KeyFunction, class Stats, class Allocator>
+    void radixSort(
+                   const RandomAccessIterator &first, const RandomAccessIterator &last,
+                   MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator> &mergeState, KeyFunction keyFn
+                  )
+    {
+        typedef typename MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type, Stats, Allocator>::BufferIterator BufferIterator;
+        typedef typename std::decay<decltype(keyFn(*first))>::type KeyType;
+        static_assert(std::is_integral<KeyType>::value && !std::is_same<KeyType, bool>::value, "radixSort needs integral keys");
+        typedef typename std::make_unsigned<KeyType>::type UnsignedKeyType;
+        const unsigned int NUMBER_OF_PASSES = sizeof(UnsignedKeyType) * 8 / RADIX_SORT_BITS;
+
+        size_t numberOfElements = last - first;
+        if (numberOfElements < 2)
+        {
+            return;
+        }
+
+        size_t counts[NUMBER_OF_PASSES][RADIX_SORT_BUCKETS] = {};
+        for (RandomAccessIterator current = first; current != last; ++current)
+        {
+            UnsignedKeyType key = getRadixKey(keyFn(*current));
+            for (unsigned int pass = 0; pass < NUMBER_OF_PASSES; ++pass)
+            {
+                ++counts[pass][(key >> (pass * RADIX_SORT_BITS)) & (RADIX_SORT_BUCKETS - 1)];
+            }
+        }
+
+        BufferIterator buffer = mergeState.moveToBuffer(first, last);
+        bool areElementsInBuffer = true;
+        for (unsigned int pass = 0; pass < NUMBER_OF_PASSES; ++pass)
+        {
+            size_t *passCounts = counts[pass];
+            unsigned int shift = pass * RADIX_SORT_BITS;
+            if (passCounts[(getRadixKey(keyFn(areElementsInBuffer ? *buffer : *first)) >> shift) & (RADIX_SORT_BUCKETS - 1)] == numberOfElements)
+            {
+                continue;
+            }
+
+            size_t offset = 0;
+            for (unsigned int bucket = 0; bucket < RADIX_SORT_BUCKETS; ++bucket)
+            {
+                size_t count = passCounts[bucket];
+                passCounts[bucket] = offset;
+                offset += count;
+            }
+
+            if (areElementsInBuffer)
+            {
+                for (BufferIterator current = buffer; current != buffer + numberOfElements; ++current)
+                {
+                    first[passCounts[(getRadixKey(keyFn(*current)) >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = std::move(*current);
+                }
+            }
+            else
+            {
+                for (RandomAccessIterator current = first; current != last; ++current)
+                {
+                    buffer[passCounts[(getRadixKey(keyFn(*current)) >> shift) & (RADIX_SORT_BUCKETS - 1)]++] = std::move(*current);
+                }
+            }
+            areElementsInBuffer = !areElementsInBuffer;
+        }
+
+        if (areElementsInBuffer)
+        {
+            std::move(buffer, buffer + numberOfElements, first);
+        }
+    }
+
+    ///Returns the end of natural run (non-descending or strictly descending), which starts at begin
+    template<class RandomAccessIterator, class Compare>
+    RandomAccessIterator findEndOfNaturalRun(const RandomAccessIterator &begin, const RandomAccessIterator &last, Compare comp)
+    {
+        RandomAccessIterator current = begin + 1;
+        if (current != last)
+        {
+            bool compareResult = compareElementWithPrevious(current, comp);
+            while (current != last && compareElementWithPrevious(current, comp) == compareResult)
+            {
+                ++current;
+            }
+        }
+        return current;
+    }
+
+    ///Pushes natural run [begin, end), found by findEndOfNaturalRun, into stack of runs without scanning it again:
+    ///the comparison of its first two elements tells, whether it is descending and shall be reversed
+    template<class RandomAccessIterator, class Compare>
+    void pushNaturalRun(
+                        const RandomAccessIterator &begin, const RandomAccessIterator &end,
+                        StackOfRuns<RandomAccessIterator> &runs, Compare comp
+                       )
+    {
+        if (end - begin > 1 && compareElementWithPrevious(begin + 1, comp))
+        {
+            std::reverse(begin, end);
+        }
+        Run naturalRun(runs.getOffset(begin), end - begin);
+        naturalRun.setPower(runs.getNodePowerBefore(naturalRun));
+        runs.push(naturalRun);
+    }
+
+    ///Natural runs of at least minRun elements are pushed into stack of runs as in timSort;
+    ///stretches between them, where all natural runs are short, are radix sorted and pushed as one run
+    ///comp shall order elements by keyFn
+    template <class RandomAccessIterator, class KeyFunction, class Compare, class Parameters>
+    void sortHybridWithParameters(
+                                  RandomAccessIterator first, RandomAccessIterator last,
+                                  const Parameters &params, KeyFunction keyFn, Compare comp,
+                                  TimSortWorkspace<RandomAccessIterator> &workspace
+                                 )
+    {
+        size_t numberOfElements = last - first;
+        unsigned int minRun = params.getMinRun(numberOfElements);
+
+        StackOfRuns<RandomAccessIterator> &runs = workspace.getRuns();
+        runs.reset(first, numberOfElements);
+        workspace.getMergeState().setMinGallop(params.getMergeStupidIterationsLimit());
+
+        for (RandomAccessIterator current = first; current != last;)
+        {
+            RandomAccessIterator stretchBegin = current;
+            RandomAccessIterator endOfRun = current;
+            while (current != last)
+            {
+                endOfRun = findEndOfNaturalRun(current, last, comp);
+                if (static_cast<size_t>(endOfRun - current) >= minRun)
+                {
+                    break;
+                }
+                current = endOfRun;
+            }
+
+            size_t stretchSize = current - stretchBegin;
+            if (stretchSize >= HYBRID_RADIX_SORT_MIN_SIZE)
+            {
+                radixSort(stretchBegin, current, workspace.getMergeState(), keyFn);
+                Run stretch(runs.getOffset(stretchBegin), stretchSize);
+                stretch.setPower(runs.getNodePowerBefore(stretch));
+                runs.push(stretch);
+                processCurrentStackOfRuns(runs, params, workspace.getMergeState(), comp);
+            }
+            else
+            {
+                for (RandomAccessIterator stretchElement = stretchBegin; stretchElement != current;)
+                {
+                    pushNextRun(stretchElement, current, runs, minRun, comp);
+                    processCurrentStackOfRuns(runs, params, workspace.getMergeState(), comp);
+                }
+            }
+
+            if (current != last)
+            {
+                pushNaturalRun(current, endOfRun, runs, comp);
+                current = endOfRun;
+                processCurrentStackOfRuns(runs, params, workspace.getMergeState(), comp);
+            }
+        }
+
+        while (runs.size() > 1)
+        {
+            runs.mergeRuns(-1, comp, params, workspace.getMergeState());
+        }
+    }
+};
+
+
+///Stable sort of [first, last) by integral keys keyFn(element) in ascending order
+///Long natural runs are merged as in timSort, stretches without them are sorted by LSD radix sort
+template <class RandomAccessIterator, class KeyFunction>
+void timSortHybrid(RandomAccessIterator first, RandomAccessIterator last, KeyFunction keyFn)
+{
+    TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator> workspace;
+    TimSortFunctionsAndClasses::TimSortPolicyDefault policy;
+    TimSortFunctionsAndClasses::sortHybridWithParameters(
+                                                         first, last, policy, keyFn,
+                                                         TimSortFunctionsAndClasses::KeyFunctionComparator<KeyFunction>(keyFn), workspace
+                                                        );
+}
+
+///Stable sort of integral values in ascending order
+template <class RandomAccessIterator>
+void timSortHybrid(RandomAccessIterator first, RandomAccessIterator last)
+{
+    TimSortFunctionsAndClasses::TimSortWorkspace<RandomAccessIterator> workspace;
+    TimSortFunctionsAndClasses::TimSortPolicyDefault policy;
+    TimSortFunctionsAndClasses::sortHybridWithParameters(
+                                                         first, last, policy, TimSortFunctionsAndClasses::IdentityKey(),
+                                                         std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>(), workspace
+                                                        );
+}
+
+#endif
@@ -0,0 +1,183 @@
+#ifndef _TIM_SORT_INCREMENTAL
+#define _TIM_SORT_INCREMENTAL
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "timsort.h"
+
+///timSort of data, which arrives by batches: runs are detected and merged while batches are pushed,
+///so only the final collapse of the stack of runs is left for finish()
+
+
+///Pushed elements are stored in the sorter; after each push all completed runs are in the stack of runs and stack invariants hold
+///The last run is pending: it may be continued by the next batch, so it is pushed into the stack, when it is broken or at finish()
+///Policy is a class with static functions like TimSortPolicyDefault; it shall make merge decisions by run sizes,
+///since node powers depend on the total number of elements, which is unknown in advance
+template<class ValueType, class Compare = std::less<ValueType>, class Policy = TimSortFunctionsAndClasses::TimSortPolicyDefault>
+class IncrementalTimSorter
+{
+    static_assert(
+                  std::is_same<typename Policy::MergeDecisionType, TimSortFunctionsAndClasses::RunSizesMergeDecision>::value,
+                  "IncrementalTimSorter needs a policy, which makes merge decisions by run sizes"
+                 );
+
+    typedef typename std::vector<ValueType>::iterator Iterator;
+
+    std::vector<ValueType> elements;
+
+    TimSortFunctionsAndClasses::StackOfRuns<Iterator> runs;
+
+    TimSortFunctionsAndClasses::MergeState<ValueType> mergeState;
+
+    Policy policy;
+
+    Compare comp;
+
+    unsigned int minRun;
+
+    ///Pending run starts at pendingOffset; its first pendingRunSize elements are a natural run (not reversed yet, if it is descending)
+    size_t pendingOffset;
+
+    size_t pendingRunSize;
+
+    bool isPendingRunDescending;
+
+    ///Natural run is open, while it reaches the end of pushed elements, so the next batch may continue it
+    bool isPendingRunOpen;
+
+    void reset()
+    {
+        runs.reset(elements.begin(), 0u);
+        mergeState.setMinGallop(policy.getMergeStupidIterationsLimit());
+        pendingOffset = 0;
+        pendingRunSize = 0;
+        isPendingRunDescending = false;
+        isPendingRunOpen = false;
+    }
+
+    ///Turns pending natural run of pendingRunSize elements into a run of runSize elements
+    void pushPendingRun(size_t runSize)
+    {
+        using namespace TimSortFunctionsAndClasses;
+        Iterator first = elements.begin() + pendingOffset;
+        if (isPendingRunDescending)
+        {
+            std::reverse(first, first + pendingRunSize);
+        }
+        if (runSize > pendingRunSize)
+        {
+            insertionSort(first, first + runSize, comp, pendingRunSize);
+        }
+        runs.push(Run(pendingOffset, runSize));
+        processCurrentStackOfRuns(runs, policy, mergeState, comp);
+
+        pendingOffset += runSize;
+        pendingRunSize = 0;
+        isPendingRunDescending = false;
+        isPendingRunOpen = false;
+    }
+
+    ///Extends pending run with new elements and pushes all runs, which can't be continued any more
+    ///Elements of a natural run are compared with their previous ones only once, even if the run spans several batches
+    void processNewElements()
+    {
+        runs.rebase(elements.begin(), elements.size());
+        while (true)
+        {
+            if (pendingRunSize == 0)
+            {
+                if (pendingOffset == elements.size())
+                {
+                    return;
+                }
+                pendingRunSize = 1;
+                isPendingRunOpen = true;
+            }
+
+            if (isPendingRunOpen)
+            {
+                for (Iterator current = elements.begin() + (pendingOffset + pendingRunSize); current != elements.end(); ++current)
+                {
+                    bool compareResult = TimSortFunctionsAndClasses::compareElementWithPrevious(current, comp);
+                    if (pendingRunSize == 1)
+                    {
+                        isPendingRunDescending = compareResult;
+                    }
+                    else if (compareResult != isPendingRunDescending)
+                    {
+                        isPendingRunOpen = false;
+                        break;
+                    }
+                    ++pendingRunSize;
+                }
+                if (isPendingRunOpen)
+                {
+                    return;
+                }
+            }
+
+            size_t runSize = std::max<size_t>(pendingRunSize, minRun);
+            if (pendingOffset + runSize > elements.size())
+            {
+                return;
+            }
+            pushPendingRun(runSize);
+        }
+    }
+public:
+    ///minRun is chosen for expectedNumberOfElements; if it is unknown, the largest minRun is used
+    explicit IncrementalTimSorter(size_t expectedNumberOfElements = 0, Compare comp = Compare()) : comp(comp)
+    {
+        minRun = policy.getMinRun(expectedNumberOfElements ? expectedNumberOfElements : std::numeric_limits<size_t>::max());
+        elements.reserve(expectedNumberOfElements);
+        reset();
+    }
+
+    template<class InputIterator>
+    void push(InputIterator first, InputIterator last)
+    {
+        elements.insert(elements.end(), first, last);
+        processNewElements();
+    }
+
+    void push(const std::vector<ValueType> &batch)
+    {
+        push(batch.begin(), batch.end());
+    }
+
+    void push(std::vector<ValueType> &&batch)
+    {
+        push(std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    }
+
+    ///Number of pushed elements
+    size_t size() const
+    {
+        return elements.size();
+    }
+
+    ///Returns all pushed elements sorted; after that the sorter is empty and can be used again
+    std::vector<ValueType> finish()
+    {
+        if (pendingRunSize != 0)
+        {
+            pushPendingRun(elements.size() - pendingOffset);
+        }
+        while (runs.size() > 1)
+        {
+            runs.mergeRuns(-1, comp, policy, mergeState);
+        }
+
+        std::vector<ValueType> result;
+        result.swap(elements);
+        reset();
+        return result;
+    }
+};
+
+#endif
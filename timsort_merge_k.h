@@ -0,0 +1,216 @@
+#ifndef _TIM_SORT_MERGE_K
+#define _TIM_SORT_MERGE_K
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+#include "timsort.h"
+
+///Merge of k sorted ranges at once with a loser tree, which gallops, when one range wins many times in a row
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Tournament of k sorted ranges: every internal node keeps the range, which lost the game in it, root keeps the winner
+    ///Ranges are leaves k, ..., 2k - 1 of the complete binary tree, internal nodes are 1, ..., k - 1, winner is in node 0
+    ///Range is before another one, if its current element is less, or elements are equal and its index is less, so merge is stable
+    ///Exhausted ranges stay in their leaves and lose every game, so a replay is O(log k) games even when a range runs out
+    template<class RandomAccessIterator, class Compare>
+    class LoserTree
+    {
+        std::vector<RandomAccessIterator> current;
+
+        std::vector<RandomAccessIterator> end;
+
+        std::vector<size_t> tree;
+
+        size_t numberOfActiveRanges;
+
+        Compare comp;
+
+        ///Plays the game in subtree of node and returns its winner
+        size_t build(size_t node)
+        {
+            if (node >= current.size())
+            {
+                return node - current.size();
+            }
+            size_t winner = build(2 * node);
+            size_t loser = build(2 * node + 1);
+            if (isBefore(loser, winner))
+            {
+                std::swap(winner, loser);
+            }
+            tree[node] = loser;
+            return winner;
+        }
+    public:
+        LoserTree(const std::vector<std::pair<RandomAccessIterator, RandomAccessIterator> > &ranges, Compare comp) :
+            tree(std::max<size_t>(ranges.size(), 1u)), numberOfActiveRanges(0), comp(comp)
+        {
+            for (size_t i = 0; i < ranges.size(); ++i)
+            {
+                current.push_back(ranges[i].first);
+                end.push_back(ranges[i].second);
+                numberOfActiveRanges += !isExhausted(i);
+            }
+            if (!current.empty())
+            {
+                tree[0] = build(1);
+            }
+        }
+
+        ///Number of ranges, which are not exhausted
+        size_t size() const
+        {
+            return numberOfActiveRanges;
+        }
+
+        bool isExhausted(size_t range) const
+        {
+            return current[range] == end[range];
+        }
+
+        bool isBefore(size_t first, size_t second) const
+        {
+            if (isExhausted(first) || isExhausted(second))
+            {
+                return !isExhausted(first);
+            }
+            if (first < second)
+            {
+                return !comp(*current[second], *current[first]);
+            }
+            return comp(*current[first], *current[second]);
+        }
+
+        ///Returns the range, whose current element is the next one in merged sequence
+        size_t getWinner() const
+        {
+            return tree[0];
+        }
+
+        ///Returns the range, which would win, if the winner were removed: it is the best of ranges, which lost to the winner
+        ///There shall be at least two ranges, which are not exhausted
+        size_t getRunnerUp() const
+        {
+            size_t winner = tree[0];
+            size_t runnerUp = tree[(current.size() + winner) / 2];
+            for (size_t node = (current.size() + winner) / 4; node > 0; node /= 2)
+            {
+                if (isBefore(tree[node], runnerUp))
+                {
+                    runnerUp = tree[node];
+                }
+            }
+            return runnerUp;
+        }
+
+        RandomAccessIterator &getCurrent(size_t range)
+        {
+            return current[range];
+        }
+
+        const RandomAccessIterator &getEnd(size_t range) const
+        {
+            return end[range];
+        }
+
+        ///Replays games on the path of the winner, after its current element was changed
+        ///Results of games are selected without branches, since they are unpredictable, when ranges are interleaved;
+        ///checks of exhausted ranges in isBefore are predictable, since each range runs out once
+        void replayWinner()
+        {
+            size_t winner = tree[0];
+            numberOfActiveRanges -= isExhausted(winner);
+            for (size_t node = (current.size() + winner) / 2; node > 0; node /= 2)
+            {
+                size_t loser = tree[node];
+                bool isLoserBefore = isBefore(loser, winner);
+                tree[node] = (isLoserBefore ? winner : loser);
+                winner = (isLoserBefore ? loser : winner);
+            }
+            tree[0] = winner;
+        }
+    };
+};
+
+
+///Stable merge of sorted ranges [ranges[i].first, ranges[i].second) into out: equal elements go in the order of ranges
+///Elements are copied (pass move iterators to move them); returns the end of output
+///When one range wins minGallop times in a row, its elements are copied by gallop up to the current element of the runner-up range,
+///so ranges, which are mostly not interleaved, are merged in O(k log n) comparisons
+template<class RandomAccessIterator, class OutputIterator, class Compare>
+OutputIterator timSortMergeK(
+                             const std::vector<std::pair<RandomAccessIterator, RandomAccessIterator> > &ranges,
+                             OutputIterator out, Compare comp
+                            ) // comp(a, b) <=> a < b;
+{
+    using namespace TimSortFunctionsAndClasses;
+    LoserTree<RandomAccessIterator, Compare> tree(ranges, comp);
+
+    size_t minGallop = TimSortPolicyDefault::MERGE_STUPID_ITERATIONS_LIMIT;
+    size_t lastWinner = ranges.size();
+    size_t winsInARow = 0;
+    bool isGalloping = false;
+
+    while (tree.size() > 0)
+    {
+        size_t winner = tree.getWinner();
+        if (winner == lastWinner)
+        {
+            ++winsInARow;
+        }
+        else
+        {
+            lastWinner = winner;
+            winsInARow = 1;
+        }
+
+        RandomAccessIterator &current = tree.getCurrent(winner);
+        if (isGalloping || winsInARow >= minGallop)
+        {
+            RandomAccessIterator nextElement = tree.getEnd(winner);
+            if (tree.size() > 1)
+            {
+                size_t runnerUp = tree.getRunnerUp();
+                nextElement = gallop(
+                                     *tree.getCurrent(runnerUp), current, nextElement, 0,
+                                     (winner < runnerUp ? EBT_UPPER_BOUND : EBT_LOWER_BOUND), comp
+                                    );
+            }
+            size_t numberOfCopiedElements = nextElement - current;
+            out = std::copy(current, nextElement, out);
+            current = nextElement;
+
+            isGalloping = (numberOfCopiedElements >= TimSortPolicyDefault::GALLOP_SUCCESS_LIMIT);
+            if (isGalloping)
+            {
+                minGallop -= (minGallop > 1);
+            }
+            else
+            {
+                ++minGallop;
+            }
+            winsInARow = 0;
+        }
+        else
+        {
+            *out = *current;
+            ++out;
+            ++current;
+        }
+        tree.replayWinner();
+    }
+    return out;
+}
+
+template<class RandomAccessIterator, class OutputIterator>
+OutputIterator timSortMergeK(const std::vector<std::pair<RandomAccessIterator, RandomAccessIterator> > &ranges, OutputIterator out)
+{
+    return timSortMergeK(ranges, out, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+}
+
+#endif
@@ -0,0 +1,360 @@
+#ifndef _TIM_SORT_PARALLEL
+#define _TIM_SORT_PARALLEL
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "timsort.h"
+
+///Multithreaded timSort; programs, which use it, shall be linked with -pthread
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Runs task(indexOfTask, indexOfThread) for all indexOfTask in [0, numberOfTasks) on numberOfThreads threads, including the calling one
+    ///Tasks are not assigned to threads beforehand: each thread takes the next task, nobody took yet, so threads, which finished early,
+    ///take over the work of slow ones
+    ///If a task throws, remaining tasks are not started and the exception is rethrown in the calling thread
+    template<class Task>
+    void runTasksInParallel(size_t numberOfTasks, unsigned int numberOfThreads, Task task)
+    {
+        numberOfThreads = static_cast<unsigned int>(std::max<size_t>(1u, std::min<size_t>(numberOfThreads, numberOfTasks)));
+
+        std::atomic<size_t> nextTask(0);
+        std::exception_ptr exception;
+        std::mutex exceptionMutex;
+
+        auto work = [&](unsigned int indexOfThread)
+        {
+            try
+            {
+                for (size_t indexOfTask = nextTask++; indexOfTask < numberOfTasks; indexOfTask = nextTask++)
+                {
+                    task(indexOfTask, indexOfThread);
+                }
+            }
+            catch (...)
+            {
+                nextTask = numberOfTasks;
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                exception = std::current_exception();
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (unsigned int indexOfThread = 1; indexOfThread < numberOfThreads; ++indexOfThread)
+        {
+            threads.push_back(std::thread(work, indexOfThread));
+        }
+        work(0);
+        for (size_t i = 0; i < threads.size(); ++i)
+        {
+            threads[i].join();
+        }
+
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+    
+    
+    ///Merges with one thread are cheaper, than starting threads, for less elements
+    const unsigned int DEFAULT_PARALLEL_MERGE_THRESHOLD = 1u << 16;
+    
+    ///Returns number of elements of [first, middle), which are among the first numberOfFirstElements elements of stable merge of [first, middle) and [middle, last)
+    ///(co-rank of numberOfFirstElements); the rest of these elements are the first elements of [middle, last)
+    template <class RandomAccessIterator, class Compare>
+    size_t coRank(
+                  size_t numberOfFirstElements, const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                  const RandomAccessIterator &last, Compare comp
+                 )
+    {
+        size_t sizeOfFirstRun = middle - first;
+        size_t sizeOfSecondRun = last - middle;
+        
+        size_t low = (numberOfFirstElements > sizeOfSecondRun ? numberOfFirstElements - sizeOfSecondRun : 0);
+        size_t high = std::min(numberOfFirstElements, sizeOfFirstRun);
+        
+        ///looking for the least fromFirstRun, such that *(first + fromFirstRun) does not go before the last taken element of the second run
+        while (low < high)
+        {
+            size_t fromFirstRun = low + (high - low) / 2;
+            size_t fromSecondRun = numberOfFirstElements - fromFirstRun;
+            if (fromSecondRun > 0 && !comp(*(middle + (fromSecondRun - 1)), *(first + fromFirstRun)))
+            {
+                low = fromFirstRun + 1;
+            }
+            else
+            {
+                high = fromFirstRun;
+            }
+        }
+        return low;
+    }
+    
+    ///Merges [first, middle) and [middle, last) on numberOfThreads threads
+    ///Output is split into numberOfThreads equal parts, and with coRank each part gets its own pieces of both runs
+    ///Pieces are rearranged, so that each part holds its piece of the first run and then its piece of the second run:
+    ///the smaller run is moved into the buffer of mergeState, pieces of the larger one are moved to their places, and pieces of the smaller one
+    ///are moved back in parallel; then the buffer is released, and parts are merged independently by merge with merge states of their threads,
+    ///so at any time buffers hold at most the smaller run, as in merge
+    template <class RandomAccessIterator, class Compare, class Parameters>
+    void parallelMerge(
+                       RandomAccessIterator first, const RandomAccessIterator &middle,
+                       RandomAccessIterator last, Compare comp, const Parameters &params, unsigned int numberOfThreads,
+                       MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type> &mergeState
+                      )
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+        typedef typename MergeState<ValueType>::BufferIterator BufferIterator;
+        
+        if (!trimRunsToMerge(first, middle, last, comp))
+        {
+            return;
+        }
+        
+        size_t numberOfElements = last - first;
+        size_t sizeOfFirstRun = middle - first;
+        unsigned int numberOfParts = numberOfThreads;
+        
+        ///part takes [beginOfPart[part], beginOfPart[part + 1]) of output, [fromFirstRunBeforePart[part], fromFirstRunBeforePart[part + 1]) of the first run
+        ///and [fromSecondRunBeforePart[part], fromSecondRunBeforePart[part + 1]) of the second one
+        std::vector<size_t> beginOfPart(numberOfParts + 1);
+        std::vector<size_t> fromFirstRunBeforePart(numberOfParts + 1);
+        std::vector<size_t> fromSecondRunBeforePart(numberOfParts + 1);
+        for (unsigned int part = 0; part <= numberOfParts; ++part)
+        {
+            beginOfPart[part] = numberOfElements * part / numberOfParts;
+            fromFirstRunBeforePart[part] = coRank(beginOfPart[part], first, middle, last, comp);
+            fromSecondRunBeforePart[part] = beginOfPart[part] - fromFirstRunBeforePart[part];
+        }
+        
+        ///pieces of the larger run only move towards the place of the buffered run, so they are moved one after another
+        ///starting from the nearest one, and none of them is overwritten before it is moved
+        bool isFirstRunInBuffer = (sizeOfFirstRun <= numberOfElements - sizeOfFirstRun);
+        BufferIterator buffer;
+        if (isFirstRunInBuffer)
+        {
+            buffer = mergeState.moveToBuffer(first, middle);
+            for (unsigned int part = 0; part < numberOfParts; ++part)
+            {
+                RandomAccessIterator source = middle + fromSecondRunBeforePart[part];
+                RandomAccessIterator destination = first + (beginOfPart[part] + fromFirstRunBeforePart[part + 1] - fromFirstRunBeforePart[part]);
+                if (source != destination)
+                {
+                    std::move(source, middle + fromSecondRunBeforePart[part + 1], destination);
+                }
+            }
+        }
+        else
+        {
+            buffer = mergeState.moveToBuffer(middle, last);
+            for (unsigned int part = numberOfParts; part > 0; --part)
+            {
+                RandomAccessIterator sourceEnd = first + fromFirstRunBeforePart[part];
+                RandomAccessIterator destinationEnd = first + (beginOfPart[part - 1] + fromFirstRunBeforePart[part] - fromFirstRunBeforePart[part - 1]);
+                if (sourceEnd != destinationEnd)
+                {
+                    std::move_backward(first + fromFirstRunBeforePart[part - 1], sourceEnd, destinationEnd);
+                }
+            }
+        }
+        
+        runTasksInParallel(
+                           numberOfParts, numberOfThreads,
+                           [&](size_t part, unsigned int)
+                           {
+                               RandomAccessIterator destination = first + beginOfPart[part];
+                               const std::vector<size_t> &fromBufferedRunBeforePart = (isFirstRunInBuffer ? fromFirstRunBeforePart : fromSecondRunBeforePart);
+                               if (!isFirstRunInBuffer)
+                               {
+                                   destination += fromFirstRunBeforePart[part + 1] - fromFirstRunBeforePart[part];
+                               }
+                               std::move(buffer + fromBufferedRunBeforePart[part], buffer + fromBufferedRunBeforePart[part + 1], destination);
+                           }
+                          );
+        mergeState.releaseBuffer();
+        
+        std::vector<MergeState<ValueType> > mergeStatesOfThreads(numberOfThreads);
+        for (unsigned int indexOfThread = 0; indexOfThread < numberOfThreads; ++indexOfThread)
+        {
+            mergeStatesOfThreads[indexOfThread].setMinGallop(params.getMergeStupidIterationsLimit());
+        }
+        runTasksInParallel(
+                           numberOfParts, numberOfThreads,
+                           [&](size_t part, unsigned int indexOfThread)
+                           {
+                               RandomAccessIterator firstOfPart = first + beginOfPart[part];
+                               merge(
+                                     firstOfPart, firstOfPart + (fromFirstRunBeforePart[part + 1] - fromFirstRunBeforePart[part]),
+                                     first + beginOfPart[part + 1], comp, params, mergeStatesOfThreads[indexOfThread]
+                                    );
+                           }
+                          );
+    }
+    
+    ///Uses parallelMerge, if there are at least parallelMergeThreshold elements to merge and more than one thread, otherwise merge
+    template <class RandomAccessIterator, class Compare, class Parameters>
+    void mergeWithThreads(
+                          const RandomAccessIterator &first, const RandomAccessIterator &middle,
+                          const RandomAccessIterator &last, Compare comp,
+                          const Parameters &params,
+                          MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type> &mergeState,
+                          unsigned int numberOfThreads, size_t parallelMergeThreshold
+                         )
+    {
+        if (numberOfThreads > 1 && static_cast<size_t>(last - first) >= parallelMergeThreshold)
+        {
+            parallelMerge(first, middle, last, comp, params, numberOfThreads, mergeState);
+        }
+        else
+        {
+            merge(first, middle, last, comp, params, mergeState);
+        }
+    }
+    
+    
+    ///Splits [first, last) into numberOfThreads chunks and finds runs (extended to minRun) in all chunks in parallel
+    ///Then merges neighbouring runs pairwise, level by level, so runs form a balanced merge tree; merges of one level are done in parallel
+    ///When a level has less merges than threads (the last levels), threads are shared between merges, and merges of at least
+    ///parallelMergeThreshold elements are split between them with parallelMerge
+    ///Sort is stable, as only neighbouring runs are merged
+    ///Extra memory is about n / 2 elements, as in timSort: merges of one level take disjoint parts of the range, each buffers at most
+    ///its smaller run, and buffers of threads are released before every level, so they don't keep the sizes of previous levels
+    template <class RandomAccessIterator, class Compare, class Parameters>
+    void parallelSortWithParameters(
+                                    RandomAccessIterator first, RandomAccessIterator last,
+                                    const Parameters &params, Compare comp,
+                                    unsigned int numberOfThreads, size_t parallelMergeThreshold
+                                   )
+    {
+        typedef typename std::iterator_traits<RandomAccessIterator>::value_type ValueType;
+
+        size_t numberOfElements = last - first;
+        unsigned int minRun = params.getMinRun(numberOfElements);
+
+        if (numberOfThreads <= 1 || numberOfElements < 2 * minRun * numberOfThreads)
+        {
+            TimSortWorkspace<RandomAccessIterator> workspace;
+            sortWithParameters(first, last, params, comp, workspace);
+            return;
+        }
+
+        unsigned int numberOfChunks = numberOfThreads;
+        std::vector<std::vector<Run> > runsOfChunks(numberOfChunks);
+
+        runTasksInParallel(
+                           numberOfChunks, numberOfThreads,
+                           [&](size_t indexOfChunk, unsigned int)
+                           {
+                               RandomAccessIterator currentElement = first + (numberOfElements * indexOfChunk / numberOfChunks);
+                               RandomAccessIterator endOfChunk = first + (numberOfElements * (indexOfChunk + 1) / numberOfChunks);
+                               ///stack of runs has fixed capacity, so every found run is moved out of it at once
+                               StackOfRuns<RandomAccessIterator> stack;
+                               stack.reset(first, numberOfElements);
+                               while (currentElement != endOfChunk)
+                               {
+                                   pushNextRun(currentElement, endOfChunk, stack, minRun, comp);
+                                   runsOfChunks[indexOfChunk].push_back(stack[-1]);
+                                   stack.pop();
+                               }
+                           }
+                          );
+
+        std::vector<Run> runs;
+        for (unsigned int indexOfChunk = 0; indexOfChunk < numberOfChunks; ++indexOfChunk)
+        {
+            runs.insert(runs.end(), runsOfChunks[indexOfChunk].begin(), runsOfChunks[indexOfChunk].end());
+        }
+
+        std::vector<MergeState<ValueType> > mergeStates(numberOfThreads);
+        for (unsigned int indexOfThread = 0; indexOfThread < numberOfThreads; ++indexOfThread)
+        {
+            mergeStates[indexOfThread].setMinGallop(params.getMergeStupidIterationsLimit());
+        }
+
+        while (runs.size() > 1)
+        {
+            size_t numberOfMerges = runs.size() / 2;
+            unsigned int threadsPerMerge = std::max<size_t>(1u, numberOfThreads / numberOfMerges);
+            for (unsigned int indexOfThread = 0; indexOfThread < numberOfThreads; ++indexOfThread)
+            {
+                mergeStates[indexOfThread].releaseBuffer();
+            }
+        
+            runTasksInParallel(
+                               numberOfMerges, numberOfThreads,
+                               [&](size_t indexOfPair, unsigned int indexOfThread)
+                               {
+                                   const Run &left = runs[2 * indexOfPair];
+                                   const Run &right = runs[2 * indexOfPair + 1];
+                                   mergeWithThreads(
+                                                    first + left.getOffset(), first + right.getOffset(),
+                                                    first + (right.getOffset() + right.getSize()),
+                                                    comp, params, mergeStates[indexOfThread], threadsPerMerge, parallelMergeThreshold
+                                                   );
+                               }
+                              );
+
+            std::vector<Run> mergedRuns;
+            for (size_t i = 0; i + 1 < runs.size(); i += 2)
+            {
+                mergedRuns.push_back(Run(runs[i].getOffset(), runs[i].getSize() + runs[i + 1].getSize()));
+            }
+            if (runs.size() % 2 == 1)
+            {
+                mergedRuns.push_back(runs.back());
+            }
+            runs.swap(mergedRuns);
+        }
+    }
+};
+
+
+///Multithreaded timSort, see parallelSortWithParameters
+template <class RandomAccessIterator, class Compare>
+void parallelTimSort(
+                     RandomAccessIterator first, RandomAccessIterator last,
+                     const TimSortFunctionsAndClasses::ITimSortParameters* const params, Compare comp,
+                     unsigned int numberOfThreads,
+                     size_t parallelMergeThreshold = TimSortFunctionsAndClasses::DEFAULT_PARALLEL_MERGE_THRESHOLD
+                    ) // comp(a, b) <=> a < b;
+{
+    TimSortFunctionsAndClasses::parallelSortWithParameters(first, last, *params, comp, numberOfThreads, parallelMergeThreshold);
+}
+
+template <class Policy, class RandomAccessIterator, class Compare>
+void parallelTimSort(
+                     RandomAccessIterator first, RandomAccessIterator last, Compare comp, unsigned int numberOfThreads,
+                     size_t parallelMergeThreshold = TimSortFunctionsAndClasses::DEFAULT_PARALLEL_MERGE_THRESHOLD
+                    ) /// comp(a, b) <=> a < b;
+{
+    Policy policy;
+    TimSortFunctionsAndClasses::parallelSortWithParameters(first, last, policy, comp, numberOfThreads, parallelMergeThreshold);
+}
+
+template <class RandomAccessIterator, class Compare>
+void parallelTimSort(RandomAccessIterator first, RandomAccessIterator last, Compare comp, unsigned int numberOfThreads) /// comp(a, b) <=> a < b;
+{
+    parallelTimSort<TimSortFunctionsAndClasses::TimSortPolicyDefault>(first, last, comp, numberOfThreads);
+}
+
+///Stable merge of [first, middle) and [middle, last) on numberOfThreads threads, if there are at least parallelMergeThreshold elements
+template <class RandomAccessIterator, class Compare>
+void parallelMerge(
+                   RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp,
+                   unsigned int numberOfThreads,
+                   size_t parallelMergeThreshold = TimSortFunctionsAndClasses::DEFAULT_PARALLEL_MERGE_THRESHOLD
+                  ) /// comp(a, b) <=> a < b;
+{
+    TimSortFunctionsAndClasses::TimSortPolicyDefault policy;
+    TimSortFunctionsAndClasses::MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type> mergeState;
+    mergeState.setMinGallop(policy.getMergeStupidIterationsLimit());
+    TimSortFunctionsAndClasses::mergeWithThreads(first, middle, last, comp, policy, mergeState, numberOfThreads, parallelMergeThreshold);
+}
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef _TIM_SORT_PARTIAL
+#define _TIM_SORT_PARTIAL
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include "timsort.h"
+
+///Stable partial sort: finds and sorts only the k least elements, dropping parts of runs, which can't be among them
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Moves size elements from source to destination, which is not after source; elements of [destination, source) go somewhere after them
+    template<class RandomAccessIterator>
+    void moveBlockBack(const RandomAccessIterator &destination, const RandomAccessIterator &source, size_t size)
+    {
+        if (destination == source)
+        {
+            return;
+        }
+        if (static_cast<size_t>(source - destination) >= size)
+        {
+            std::swap_ranges(source, source + size, destination);
+        }
+        else
+        {
+            std::rotate(destination, source, source + size);
+        }
+    }
+
+    ///Elements are kept at the beginning of [first, last): sorted prefix of the k least processed elements (empty before the first collapse)
+    ///and the runs in stack, which follow it; only elements, which can be among the k least ones, are kept:
+    ///at most k first elements of each run, and, if prefix is not empty, only elements less than its last element (equal ones are after it in stable order)
+    ///When 2k elements are kept, stack is merged into prefix, which is cut to k elements, so every kept element takes part in O(log k) merges
+    template <class RandomAccessIterator, class Compare, class Parameters>
+    void partialSortWithParameters(
+                                   RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last,
+                                   const Parameters &params, Compare comp,
+                                   TimSortWorkspace<RandomAccessIterator> &workspace
+                                  )
+    {
+        size_t numberOfElements = last - first;
+        size_t numberOfLeastElements = middle - first;
+        unsigned int minRun = params.getMinRun(numberOfElements);
+
+        StackOfRuns<RandomAccessIterator> &runs = workspace.getRuns();
+        runs.reset(first, numberOfElements);
+        MergeState<typename std::iterator_traits<RandomAccessIterator>::value_type> &mergeState = workspace.getMergeState();
+        mergeState.setMinGallop(params.getMergeStupidIterationsLimit());
+
+        size_t sizeOfPrefix = 0;
+        size_t numberOfKeptElements = 0;
+        RandomAccessIterator currentElement = first;
+        while (true)
+        {
+            if (currentElement == last || numberOfKeptElements >= 2 * numberOfLeastElements)
+            {
+                while (runs.size() > 1)
+                {
+                    runs.mergeRuns(-1, comp, params, mergeState);
+                }
+                runs.reset(first, numberOfElements);
+                merge(first, first + sizeOfPrefix, first + numberOfKeptElements, comp, params, mergeState);
+                sizeOfPrefix = numberOfKeptElements = std::min(numberOfKeptElements, numberOfLeastElements);
+                if (currentElement == last)
+                {
+                    return;
+                }
+            }
+
+            if (sizeOfPrefix == 0)
+            {
+                RandomAccessIterator beginOfRun = currentElement;
+                pushNextRun(currentElement, last, runs, minRun, comp);
+                runs.pop();
+
+                size_t sizeOfKeptPart = std::min(static_cast<size_t>(currentElement - beginOfRun), numberOfLeastElements);
+                moveBlockBack(first + numberOfKeptElements, beginOfRun, sizeOfKeptPart);
+                Run keptPart(numberOfKeptElements, sizeOfKeptPart);
+                keptPart.setPower(runs.getNodePowerBefore(keptPart));
+                runs.push(keptPart);
+                numberOfKeptElements += sizeOfKeptPart;
+                processCurrentStackOfRuns(runs, params, mergeState, comp);
+            }
+            else
+            {
+                ///Elements, which are not less than the last element of prefix, are dropped after one comparison;
+                ///up to k other ones are moved after kept elements in their order, and runs are found among them
+                const RandomAccessIterator beginOfBatch = first + numberOfKeptElements;
+                RandomAccessIterator endOfBatch = beginOfBatch;
+                for (; currentElement != last && static_cast<size_t>(endOfBatch - beginOfBatch) < numberOfLeastElements; ++currentElement)
+                {
+                    if (comp(*currentElement, first[sizeOfPrefix - 1]))
+                    {
+                        if (endOfBatch != currentElement)
+                        {
+                            std::iter_swap(endOfBatch, currentElement);
+                        }
+                        ++endOfBatch;
+                    }
+                }
+
+                for (RandomAccessIterator elementOfBatch = beginOfBatch; elementOfBatch != endOfBatch;)
+                {
+                    pushNextRun(elementOfBatch, endOfBatch, runs, minRun, comp);
+                    processCurrentStackOfRuns(runs, params, mergeState, comp);
+                }
+                numberOfKeptElements += endOfBatch - beginOfBatch;
+            }
+        }
+    }
+
+    template <class RandomAccessIterator, class Compare>
+    void partialSortWithNewWorkspace(
+                                     RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp,
+                                     std::false_type
+                                    )
+    {
+        TimSortWorkspace<RandomAccessIterator> workspace;
+        TimSortPolicyDefault policy;
+        partialSortWithParameters(first, middle, last, policy, comp, workspace);
+    }
+
+    ///As in sortWithNewWorkspace, contiguous ranges are sorted by pointers
+    template <class RandomAccessIterator, class Compare>
+    void partialSortWithNewWorkspace(
+                                     RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp,
+                                     std::true_type
+                                    )
+    {
+        typename std::iterator_traits<RandomAccessIterator>::value_type *pointerToFirst = std::addressof(*first);
+        partialSortWithNewWorkspace(
+                                    pointerToFirst, pointerToFirst + (middle - first), pointerToFirst + (last - first), comp,
+                                    std::false_type()
+                                   );
+    }
+};
+
+
+///Places the (middle - first) least elements of [first, last) into [first, middle) in stable sorted order, as stable partial_sort;
+///order of [middle, last) is unspecified
+///Runs are found as in timSort; parts of them, which can't be among the least elements, are dropped without merging,
+///so mostly ordered data takes O(n) comparisons, and any data takes O(n log k) comparisons for k = middle - first
+template <class RandomAccessIterator, class Compare>
+void timSortPartial(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last, Compare comp) // comp(a, b) <=> a < b;
+{
+    if (middle == first)
+    {
+        return;
+    }
+    if (middle == last)
+    {
+        timSort(first, last, comp);
+        return;
+    }
+    TimSortFunctionsAndClasses::partialSortWithNewWorkspace(
+                                                            first, middle, last, comp,
+                                                            typename TimSortFunctionsAndClasses::IsContiguousIterator<RandomAccessIterator>::type()
+                                                           );
+}
+
+template <class RandomAccessIterator>
+void timSortPartial(RandomAccessIterator first, RandomAccessIterator middle, RandomAccessIterator last)
+{
+    timSortPartial(first, middle, last, std::less<typename std::iterator_traits<RandomAccessIterator>::value_type>());
+}
+
+#endif
@@ -0,0 +1,450 @@
+#ifndef _TIM_SORT_STRINGS
+#define _TIM_SORT_STRINGS
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "timsort.h"
+
+///timSort of std::string in lexicographic order, which keeps the length of the longest common prefix (LCP) of each element and the previous one in its run
+///Merges compare LCPs first and compare characters only from the known common prefix on, so long shared prefixes (URLs, paths) are not rescanned
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Returns the length of the longest common prefix of first and second, whose first knownPrefixLength characters are known to be equal
+    ///Characters are compared by 8 at once, while they are equal
+    inline size_t getCommonPrefixLength(const std::string &first, const std::string &second, size_t knownPrefixLength)
+    {
+        size_t maxLength = std::min(first.size(), second.size());
+        size_t length = knownPrefixLength;
+        const char *firstData = first.data();
+        const char *secondData = second.data();
+        while (length + sizeof(unsigned long long) <= maxLength)
+        {
+            unsigned long long firstWord, secondWord;
+            memcpy(&firstWord, firstData + length, sizeof(firstWord));
+            memcpy(&secondWord, secondData + length, sizeof(secondWord));
+            if (firstWord != secondWord)
+            {
+                break;
+            }
+            length += sizeof(unsigned long long);
+        }
+        while (length < maxLength && firstData[length] == secondData[length])
+        {
+            ++length;
+        }
+        return length;
+    }
+
+    ///Returns true, if first < second, when their longest common prefix has commonPrefixLength characters (characters are compared as unsigned, as in std::string)
+    inline bool isLessAfterCommonPrefix(const std::string &first, const std::string &second, size_t commonPrefixLength)
+    {
+        return commonPrefixLength < second.size() &&
+               (commonPrefixLength == first.size() ||
+                static_cast<unsigned char>(first[commonPrefixLength]) < static_cast<unsigned char>(second[commonPrefixLength]));
+    }
+
+    ///Sorts [first, last) as timSort with policy Policy, but keeps lcp[i] = LCP(first[i - 1], first[i]) for all elements except the first ones of runs
+    template<class RandomAccessIterator, class Policy>
+    class LcpTimSorter
+    {
+        RandomAccessIterator first;
+
+        size_t numberOfElements;
+
+        std::vector<size_t> lcp;
+
+        Policy policy;
+
+        StackOfRuns<RandomAccessIterator> runs;
+
+        MergeState<std::string> mergeState;
+
+        typedef typename MergeState<std::string>::BufferIterator BufferIterator;
+
+        std::vector<size_t> lcpBuffer;
+
+        ///Recomputes LCPs of elements of [begin + 1, end)
+        void computeLcps(size_t begin, size_t end)
+        {
+            for (size_t i = begin + 1; i < end; ++i)
+            {
+                lcp[i] = getCommonPrefixLength(first[i - 1], first[i], 0);
+            }
+        }
+
+        ///Finds natural run, which starts at offset begin (LCPs of neighbours are found together with their order), extends it to minRun elements
+        ///by insertion sort and pushes it into stack; returns the end of the run
+        size_t pushNextRun(size_t begin, unsigned int minRun)
+        {
+            size_t end = begin + 1;
+            if (end < numberOfElements)
+            {
+                lcp[end] = getCommonPrefixLength(first[end - 1], first[end], 0);
+                bool isDescending = isLessAfterCommonPrefix(first[end], first[end - 1], lcp[end]);
+                ++end;
+                while (end < numberOfElements)
+                {
+                    lcp[end] = getCommonPrefixLength(first[end - 1], first[end], 0);
+                    if (isLessAfterCommonPrefix(first[end], first[end - 1], lcp[end]) != isDescending)
+                    {
+                        break;
+                    }
+                    ++end;
+                }
+
+                if (isDescending)
+                {
+                    ///LCP of neighbours doesn't depend on their order, so LCPs are reversed together with elements
+                    std::reverse(first + begin, first + end);
+                    std::reverse(lcp.begin() + (begin + 1), lcp.begin() + end);
+                }
+
+                if (end < numberOfElements && end - begin < minRun)
+                {
+                    size_t sortedSize = end - begin;
+                    end = std::min(numberOfElements, begin + minRun);
+                    insertionSort(first + begin, first + end, std::less<std::string>(), sortedSize);
+                    computeLcps(begin, end);
+                }
+            }
+
+            Run nextRun(begin, end - begin);
+            nextRun.setPower(runs.getNodePowerBefore(nextRun));
+            runs.push(nextRun);
+            return end;
+        }
+
+        ///Copies LCPs of elements [begin, end) into the beginning of lcpBuffer, which grows geometrically as the merge buffer
+        void copyLcpsToBuffer(size_t begin, size_t end)
+        {
+            if (lcpBuffer.size() < end - begin)
+            {
+                lcpBuffer.resize(std::max(end - begin, 2 * lcpBuffer.size()));
+            }
+            std::copy(lcp.begin() + begin, lcp.begin() + end, lcpBuffer.begin());
+        }
+
+        ///Of the current elements of the first and the second run, which are both on the same side of the last merged element
+        ///(after it in forward merge, before it in backward one), returns true, if the element of the first run is merged next
+        ///The one with greater LCP with the last merged element is closer to it; characters are compared only if LCPs are equal, and only after the common prefix,
+        ///then LCP of the element, which is not taken, with the taken one is stored
+        ///Of equal elements, forward merge takes the one of the first run, and backward merge takes the one of the second run, so merge is stable
+        static bool isFirstRunTaken(
+                                    const std::string &elementOfFirst, size_t &lcpOfFirst,
+                                    const std::string &elementOfSecond, size_t &lcpOfSecond, bool isForward
+                                   )
+        {
+            if (lcpOfFirst != lcpOfSecond)
+            {
+                return lcpOfFirst > lcpOfSecond;
+            }
+            size_t commonPrefixLength = getCommonPrefixLength(elementOfFirst, elementOfSecond, lcpOfFirst);
+            bool isTaken = (isLessAfterCommonPrefix(elementOfSecond, elementOfFirst, commonPrefixLength) != isForward);
+            if (isTaken)
+            {
+                lcpOfSecond = commonPrefixLength;
+            }
+            else
+            {
+                lcpOfFirst = commonPrefixLength;
+            }
+            return isTaken;
+        }
+
+        ///As in mergeLeft, min_gallop decreases after a gallop, which moved at least getGallopSuccessLimit() elements, and increases otherwise
+        void adaptMinGallop(size_t &minGallop, size_t numberOfMovedElements) const
+        {
+            if (numberOfMovedElements >= policy.getGallopSuccessLimit())
+            {
+                minGallop -= (minGallop > 1);
+            }
+            else
+            {
+                ++minGallop;
+            }
+        }
+
+        ///Moves size elements from source, whose LCPs with previous elements of their run are at sourceLcps, to placeToInsert;
+        ///lcpOfBlock is LCP of the first of them with the element before placeToInsert
+        template<class Iterator>
+        void moveBlockForward(Iterator source, std::vector<size_t>::const_iterator sourceLcps, size_t size, size_t placeToInsert, size_t lcpOfBlock)
+        {
+            std::move(source, source + size, first + placeToInsert);
+            std::copy(sourceLcps + 1, sourceLcps + size, lcp.begin() + (placeToInsert + 1));
+            lcp[placeToInsert] = lcpOfBlock;
+        }
+
+        ///Moves size elements before sourceEnd, whose LCPs with previous elements of their run are before sourceLcpsEnd, to the positions before endOfPlace;
+        ///lcpOfBlock is LCP of the last of them with the element at endOfPlace
+        template<class Iterator>
+        void moveBlockBackward(Iterator sourceEnd, std::vector<size_t>::const_iterator sourceLcpsEnd, size_t size, size_t endOfPlace, size_t lcpOfBlock)
+        {
+            std::move_backward(sourceEnd - size, sourceEnd, first + endOfPlace);
+            std::copy_backward(sourceLcpsEnd - (size - 1), sourceLcpsEnd, lcp.begin() + endOfPlace);
+            lcp[endOfPlace] = lcpOfBlock;
+        }
+
+        ///LCP merge of trimmed runs [firstToMerge, middle) and [middle, lastToMerge) with buffer for the first run, which is not larger, from the beginning to the end
+        ///The first element of the second run is the least one, so it is placed first; when one run wins minGallop times in a row,
+        ///its elements up to the current element of the other run are found by gallop and moved at once
+        ///LCPs of elements at firstToMerge and lastToMerge are set by merge
+        void mergeForward(size_t firstToMerge, size_t middle, size_t lastToMerge)
+        {
+            size_t sizeOfFirst = middle - firstToMerge;
+            BufferIterator buffer = mergeState.moveToBuffer(first + firstToMerge, first + middle);
+            copyLcpsToBuffer(firstToMerge, middle);
+
+            size_t lcpOfFirst = getCommonPrefixLength(buffer[0], first[middle], 0);
+            first[firstToMerge] = std::move(first[middle]);
+
+            size_t placeToInsert = firstToMerge + 1;
+            size_t elementOfFirst = 0;
+            size_t elementOfSecond = middle + 1;
+            size_t lcpOfSecond = (elementOfSecond < lastToMerge ? lcp[elementOfSecond] : 0);
+            size_t minGallop = mergeState.getMinGallop();
+            size_t winsOfFirst = 0;
+            size_t winsOfSecond = 0;
+            while (elementOfFirst < sizeOfFirst && elementOfSecond < lastToMerge)
+            {
+                ///LCP of the element, which is not taken, with the last element of the taken block is not less than with the first one
+                if (isFirstRunTaken(buffer[elementOfFirst], lcpOfFirst, first[elementOfSecond], lcpOfSecond, true))
+                {
+                    winsOfSecond = 0;
+                    size_t endOfBlock = elementOfFirst + 1;
+                    if (++winsOfFirst >= minGallop)
+                    {
+                        endOfBlock = gallop(
+                                            first[elementOfSecond], buffer + endOfBlock, buffer + sizeOfFirst, 0,
+                                            EBT_UPPER_BOUND, std::less<std::string>()
+                                           ) - buffer;
+                        adaptMinGallop(minGallop, endOfBlock - elementOfFirst);
+                        winsOfFirst = 0;
+                    }
+                    moveBlockForward(buffer + elementOfFirst, lcpBuffer.begin() + elementOfFirst, endOfBlock - elementOfFirst, placeToInsert, lcpOfFirst);
+                    placeToInsert += endOfBlock - elementOfFirst;
+                    if (endOfBlock > elementOfFirst + 1)
+                    {
+                        lcpOfSecond = getCommonPrefixLength(first[placeToInsert - 1], first[elementOfSecond], lcpOfSecond);
+                    }
+                    elementOfFirst = endOfBlock;
+                    if (elementOfFirst < sizeOfFirst)
+                    {
+                        lcpOfFirst = lcpBuffer[elementOfFirst];
+                    }
+                }
+                else
+                {
+                    winsOfFirst = 0;
+                    size_t endOfBlock = elementOfSecond + 1;
+                    if (++winsOfSecond >= minGallop)
+                    {
+                        endOfBlock = gallop(
+                                            buffer[elementOfFirst], first + endOfBlock, first + lastToMerge, 0,
+                                            EBT_LOWER_BOUND, std::less<std::string>()
+                                           ) - first;
+                        adaptMinGallop(minGallop, endOfBlock - elementOfSecond);
+                        winsOfSecond = 0;
+                    }
+                    moveBlockForward(first + elementOfSecond, lcp.begin() + elementOfSecond, endOfBlock - elementOfSecond, placeToInsert, lcpOfSecond);
+                    placeToInsert += endOfBlock - elementOfSecond;
+                    if (endOfBlock > elementOfSecond + 1)
+                    {
+                        lcpOfFirst = getCommonPrefixLength(first[placeToInsert - 1], buffer[elementOfFirst], lcpOfFirst);
+                    }
+                    elementOfSecond = endOfBlock;
+                    if (elementOfSecond < lastToMerge)
+                    {
+                        lcpOfSecond = lcp[elementOfSecond];
+                    }
+                }
+            }
+            mergeState.setMinGallop(minGallop);
+
+            if (elementOfFirst < sizeOfFirst)
+            {
+                moveBlockForward(buffer + elementOfFirst, lcpBuffer.begin() + elementOfFirst, sizeOfFirst - elementOfFirst, placeToInsert, lcpOfFirst);
+            }
+            else
+            {
+                ///the rest of the second run is in place, only LCP of its first element changes
+                lcp[placeToInsert] = lcpOfSecond;
+            }
+        }
+
+        ///Mirror of mergeForward: buffers the second run, which is smaller, and merges from the end to the beginning
+        ///The last element of the first run is the greatest one, so it is placed first; LCPs of the current elements are kept with the next merged element,
+        ///which is the next one in their run, so they are the stored LCPs of the next elements
+        void mergeBackward(size_t firstToMerge, size_t middle, size_t lastToMerge)
+        {
+            size_t sizeOfSecond = lastToMerge - middle;
+            BufferIterator buffer = mergeState.moveToBuffer(first + middle, first + lastToMerge);
+            copyLcpsToBuffer(middle, lastToMerge);
+
+            first[lastToMerge - 1] = std::move(first[middle - 1]);
+            size_t lcpOfSecond = getCommonPrefixLength(buffer[sizeOfSecond - 1], first[lastToMerge - 1], 0);
+
+            size_t placeToInsert = lastToMerge - 1;
+            size_t elementOfFirst = middle - 1;
+            size_t elementOfSecond = sizeOfSecond;
+            size_t lcpOfFirst = (elementOfFirst > firstToMerge ? lcp[elementOfFirst] : 0);
+            size_t minGallop = mergeState.getMinGallop();
+            size_t winsOfFirst = 0;
+            size_t winsOfSecond = 0;
+            while (elementOfFirst > firstToMerge && elementOfSecond > 0)
+            {
+                if (isFirstRunTaken(first[elementOfFirst - 1], lcpOfFirst, buffer[elementOfSecond - 1], lcpOfSecond, false))
+                {
+                    winsOfSecond = 0;
+                    size_t beginOfBlock = elementOfFirst - 1;
+                    if (++winsOfFirst >= minGallop)
+                    {
+                        beginOfBlock = gallop(
+                                              buffer[elementOfSecond - 1], first + firstToMerge, first + beginOfBlock, (beginOfBlock - firstToMerge) - 1,
+                                              EBT_UPPER_BOUND, std::less<std::string>()
+                                             ) - first;
+                        adaptMinGallop(minGallop, elementOfFirst - beginOfBlock);
+                        winsOfFirst = 0;
+                    }
+                    moveBlockBackward(first + elementOfFirst, lcp.begin() + elementOfFirst, elementOfFirst - beginOfBlock, placeToInsert, lcpOfFirst);
+                    placeToInsert -= elementOfFirst - beginOfBlock;
+                    if (beginOfBlock + 1 < elementOfFirst)
+                    {
+                        lcpOfSecond = getCommonPrefixLength(first[placeToInsert], buffer[elementOfSecond - 1], lcpOfSecond);
+                    }
+                    elementOfFirst = beginOfBlock;
+                    if (elementOfFirst > firstToMerge)
+                    {
+                        lcpOfFirst = lcp[elementOfFirst];
+                    }
+                }
+                else
+                {
+                    winsOfFirst = 0;
+                    size_t beginOfBlock = elementOfSecond - 1;
+                    if (++winsOfSecond >= minGallop)
+                    {
+                        beginOfBlock = gallop(
+                                              first[elementOfFirst - 1], buffer, buffer + beginOfBlock, beginOfBlock - 1,
+                                              EBT_LOWER_BOUND, std::less<std::string>()
+                                             ) - buffer;
+                        adaptMinGallop(minGallop, elementOfSecond - beginOfBlock);
+                        winsOfSecond = 0;
+                    }
+                    moveBlockBackward(buffer + elementOfSecond, lcpBuffer.begin() + elementOfSecond, elementOfSecond - beginOfBlock, placeToInsert, lcpOfSecond);
+                    placeToInsert -= elementOfSecond - beginOfBlock;
+                    if (beginOfBlock + 1 < elementOfSecond)
+                    {
+                        lcpOfFirst = getCommonPrefixLength(first[placeToInsert], first[elementOfFirst - 1], lcpOfFirst);
+                    }
+                    elementOfSecond = beginOfBlock;
+                    if (elementOfSecond > 0)
+                    {
+                        lcpOfSecond = lcpBuffer[elementOfSecond];
+                    }
+                }
+            }
+            mergeState.setMinGallop(minGallop);
+
+            if (elementOfSecond > 0)
+            {
+                moveBlockBackward(buffer + elementOfSecond, lcpBuffer.begin() + elementOfSecond, elementOfSecond, placeToInsert, lcpOfSecond);
+            }
+            else
+            {
+                ///the rest of the first run is in place, only LCP of the element after it changes
+                lcp[placeToInsert] = lcpOfFirst;
+            }
+        }
+
+        ///LCP merge of runs [begin, middle) and [middle, end): as in mergeTrimmed, elements, which are already in place, are skipped,
+        ///and the smaller of the rest of the runs is buffered
+        void merge(size_t begin, size_t middle, size_t end)
+        {
+            RandomAccessIterator firstToMerge = first + begin;
+            RandomAccessIterator lastToMerge = first + end;
+            if (!trimRunsToMerge(firstToMerge, first + middle, lastToMerge, std::less<std::string>()))
+            {
+                ///runs are in order, but the first element of the second run is not the first one of a run any more, so its LCP is needed
+                lcp[middle] = getCommonPrefixLength(first[middle - 1], first[middle], 0);
+                return;
+            }
+
+            ///the first element of the second run becomes the first merged element, and the last element of the first run becomes the last one,
+            ///so their LCPs with the elements, which are in place around the merged part, are found before the merge
+            size_t lcpBeforeMerged = (firstToMerge != first + begin ? getCommonPrefixLength(firstToMerge[-1], first[middle], 0) : 0);
+            size_t lcpAfterMerged = (lastToMerge != first + end ? getCommonPrefixLength(first[middle - 1], *lastToMerge, 0) : 0);
+            if (first + middle - firstToMerge <= lastToMerge - (first + middle))
+            {
+                mergeForward(firstToMerge - first, middle, lastToMerge - first);
+            }
+            else
+            {
+                mergeBackward(firstToMerge - first, middle, lastToMerge - first);
+            }
+            lcp[firstToMerge - first] = lcpBeforeMerged;
+            if (lastToMerge != first + end)
+            {
+                lcp[lastToMerge - first] = lcpAfterMerged;
+            }
+        }
+
+        void mergeRuns(int indexOfSecondMergingElement)
+        {
+            const Run &firstRun = runs[indexOfSecondMergingElement - 1];
+            const Run &secondRun = runs[indexOfSecondMergingElement];
+            merge(firstRun.getOffset(), secondRun.getOffset(), secondRun.getOffset() + secondRun.getSize());
+            runs.joinRuns(indexOfSecondMergingElement);
+        }
+    public:
+        LcpTimSorter(const RandomAccessIterator &first, const RandomAccessIterator &last) :
+            first(first), numberOfElements(last - first), lcp(numberOfElements)
+        {
+        }
+
+        void sort()
+        {
+            unsigned int minRun = policy.getMinRun(numberOfElements);
+            runs.reset(first, numberOfElements);
+            mergeState.setMinGallop(policy.getMergeStupidIterationsLimit());
+
+            for (size_t currentElement = 0; currentElement < numberOfElements;)
+            {
+                currentElement = pushNextRun(currentElement, minRun);
+                for (int index = getNextMerge(runs, policy); index != 0; index = getNextMerge(runs, policy))
+                {
+                    mergeRuns(index);
+                }
+            }
+
+            while (runs.size() > 1)
+            {
+                mergeRuns(-1);
+            }
+        }
+    };
+};
+
+
+///Stable sort of std::string in lexicographic order (as std::less<std::string>), which doesn't rescan common prefixes during merges
+///Pays off, when strings share long prefixes; for short strings LCP bookkeeping makes it slower than timSort
+///Takes O(n) extra memory for LCPs besides the merge buffer of timSort
+template<class RandomAccessIterator>
+void timSortStrings(RandomAccessIterator first, RandomAccessIterator last)
+{
+    static_assert(
+                  std::is_same<typename std::iterator_traits<RandomAccessIterator>::value_type, std::string>::value,
+                  "timSortStrings sorts std::string"
+                 );
+    TimSortFunctionsAndClasses::LcpTimSorter<RandomAccessIterator, TimSortFunctionsAndClasses::TimSortPolicyDefault> sorter(first, last);
+    sorter.sort();
+}
+
+#endif
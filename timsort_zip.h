@@ -0,0 +1,253 @@
+#ifndef _TIM_SORT_ZIP
+#define _TIM_SORT_ZIP
+
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include "timsort.h"
+
+///timSort of parallel arrays (keys and values): elements of both arrays are moved together, but only keys are compared,
+///so pairs are not built for the whole range, only for elements, which are in merge buffer
+
+
+namespace TimSortFunctionsAndClasses
+{
+    ///Reference to key and value with the same index in two arrays
+    ///timSort converts references to values and assigns them only to move elements, so conversion moves key and value out
+    template<class KeyIterator, class ValueIterator>
+    class ZipReference
+    {
+        typedef typename std::iterator_traits<KeyIterator>::value_type KeyType;
+
+        typedef typename std::iterator_traits<ValueIterator>::value_type MappedType;
+
+        KeyIterator key;
+
+        ValueIterator value;
+    public:
+        typedef std::pair<KeyType, MappedType> ValueType;
+
+        ZipReference(const KeyIterator &key, const ValueIterator &value) : key(key), value(value)
+        {
+        }
+
+        ZipReference(const ZipReference &other) : key(other.key), value(other.value)
+        {
+        }
+
+        const KeyType &getKey() const
+        {
+            return *key;
+        }
+
+        operator ValueType() const
+        {
+            return ValueType(std::move(*key), std::move(*value));
+        }
+
+        const ZipReference &operator=(const ValueType &other) const
+        {
+            *key = other.first;
+            *value = other.second;
+            return *this;
+        }
+
+        const ZipReference &operator=(ValueType &&other) const
+        {
+            *key = std::move(other.first);
+            *value = std::move(other.second);
+            return *this;
+        }
+
+        const ZipReference &operator=(const ZipReference &other) const
+        {
+            *key = std::move(*other.key);
+            *value = std::move(*other.value);
+            return *this;
+        }
+
+        friend void swap(const ZipReference &first, const ZipReference &second)
+        {
+            using std::swap;
+            swap(*first.key, *second.key);
+            swap(*first.value, *second.value);
+        }
+    };
+
+    ///Random access iterator over two arrays at once; its value_type is pair of key and value, its reference is ZipReference
+    template<class KeyIterator, class ValueIterator>
+    class ZipIterator
+    {
+        KeyIterator key;
+
+        ValueIterator value;
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef typename ZipReference<KeyIterator, ValueIterator>::ValueType value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef void pointer;
+        typedef ZipReference<KeyIterator, ValueIterator> reference;
+
+        ZipIterator() : key(), value()
+        {
+        }
+
+        ZipIterator(const KeyIterator &key, const ValueIterator &value) : key(key), value(value)
+        {
+        }
+
+        reference operator*() const
+        {
+            return reference(key, value);
+        }
+
+        reference operator[](difference_type offset) const
+        {
+            return reference(key + offset, value + offset);
+        }
+
+        ZipIterator &operator++()
+        {
+            ++key;
+            ++value;
+            return *this;
+        }
+
+        ZipIterator operator++(int)
+        {
+            ZipIterator result = *this;
+            ++*this;
+            return result;
+        }
+
+        ZipIterator &operator--()
+        {
+            --key;
+            --value;
+            return *this;
+        }
+
+        ZipIterator operator--(int)
+        {
+            ZipIterator result = *this;
+            --*this;
+            return result;
+        }
+
+        ZipIterator &operator+=(difference_type offset)
+        {
+            key += offset;
+            value += offset;
+            return *this;
+        }
+
+        ZipIterator &operator-=(difference_type offset)
+        {
+            key -= offset;
+            value -= offset;
+            return *this;
+        }
+
+        ZipIterator operator+(difference_type offset) const
+        {
+            return ZipIterator(key + offset, value + offset);
+        }
+
+        friend ZipIterator operator+(difference_type offset, const ZipIterator &iterator)
+        {
+            return iterator + offset;
+        }
+
+        ZipIterator operator-(difference_type offset) const
+        {
+            return ZipIterator(key - offset, value - offset);
+        }
+
+        ///Key and value iterators always move together, so it is enough to compare key iterators
+        difference_type operator-(const ZipIterator &other) const
+        {
+            return key - other.key;
+        }
+
+        bool operator==(const ZipIterator &other) const
+        {
+            return key == other.key;
+        }
+
+        bool operator!=(const ZipIterator &other) const
+        {
+            return key != other.key;
+        }
+
+        bool operator<(const ZipIterator &other) const
+        {
+            return key < other.key;
+        }
+
+        bool operator>(const ZipIterator &other) const
+        {
+            return key > other.key;
+        }
+
+        bool operator<=(const ZipIterator &other) const
+        {
+            return key <= other.key;
+        }
+
+        bool operator>=(const ZipIterator &other) const
+        {
+            return key >= other.key;
+        }
+    };
+
+    template<class KeyIterator, class ValueIterator>
+    const typename std::iterator_traits<KeyIterator>::value_type &getZippedKey(const ZipReference<KeyIterator, ValueIterator> &reference)
+    {
+        return reference.getKey();
+    }
+
+    template<class KeyType, class MappedType>
+    const KeyType &getZippedKey(const std::pair<KeyType, MappedType> &element)
+    {
+        return element.first;
+    }
+
+    ///Compares zipped elements (references to arrays or pairs in merge buffer) by keys only
+    template<class Compare>
+    class ZipKeyComparator
+    {
+        Compare comp;
+    public:
+        ZipKeyComparator(Compare comp) : comp(comp)
+        {
+        }
+
+        template<class FirstType, class SecondType>
+        bool operator()(const FirstType &first, const SecondType &second) const
+        {
+            return comp(getZippedKey(first), getZippedKey(second));
+        }
+    };
+};
+
+
+///Sorts keys [keysFirst, keysLast) stably in the order of comp and permutes values [valuesFirst, valuesFirst + (keysLast - keysFirst)) in the same way
+///Run detection and comparisons read keys only; merge buffer holds pairs of keys and values of one run
+template<class KeyIterator, class ValueIterator, class Compare>
+void timSortZip(KeyIterator keysFirst, KeyIterator keysLast, ValueIterator valuesFirst, Compare comp) // comp(a, b) <=> a < b;
+{
+    typedef TimSortFunctionsAndClasses::ZipIterator<KeyIterator, ValueIterator> Iterator;
+    timSort(
+            Iterator(keysFirst, valuesFirst), Iterator(keysLast, valuesFirst + (keysLast - keysFirst)),
+            TimSortFunctionsAndClasses::ZipKeyComparator<Compare>(comp)
+           );
+}
+
+template<class KeyIterator, class ValueIterator>
+void timSortZip(KeyIterator keysFirst, KeyIterator keysLast, ValueIterator valuesFirst)
+{
+    timSortZip(keysFirst, keysLast, valuesFirst, std::less<typename std::iterator_traits<KeyIterator>::value_type>());
+}
+
+#endif
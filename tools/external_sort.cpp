@@ -0,0 +1,61 @@
+///Sorts binary file of numbers, which may not fit into memory
+///argv = [name, typeOfRecord, inputFile, outputFile, memoryInMegabytes]
+///typeOfRecord is one of: int, unsigned, longlong, ulonglong, double
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "../timsort_external.h"
+
+
+template<class Record>
+void sortFile(const char *inputFileName, const char *outputFileName, size_t memoryInMegabytes)
+{
+    externalTimSort<Record>(inputFileName, outputFileName, memoryInMegabytes << 20);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc < 5)
+    {
+        fprintf(stderr, "Usage: %s int|unsigned|longlong|ulonglong|double inputFile outputFile memoryInMegabytes\n", argv[0]);
+        return 1;
+    }
+    const char *typeOfRecord = argv[1];
+    size_t memoryInMegabytes = strtoull(argv[4], 0, 10);
+
+    try
+    {
+        if (strcmp(typeOfRecord, "int") == 0)
+        {
+            sortFile<int>(argv[2], argv[3], memoryInMegabytes);
+        }
+        else if (strcmp(typeOfRecord, "unsigned") == 0)
+        {
+            sortFile<unsigned int>(argv[2], argv[3], memoryInMegabytes);
+        }
+        else if (strcmp(typeOfRecord, "longlong") == 0)
+        {
+            sortFile<long long>(argv[2], argv[3], memoryInMegabytes);
+        }
+        else if (strcmp(typeOfRecord, "ulonglong") == 0)
+        {
+            sortFile<unsigned long long>(argv[2], argv[3], memoryInMegabytes);
+        }
+        else if (strcmp(typeOfRecord, "double") == 0)
+        {
+            sortFile<double>(argv[2], argv[3], memoryInMegabytes);
+        }
+        else
+        {
+            fprintf(stderr, "Unknown type of record: %s\n", typeOfRecord);
+            return 1;
+        }
+    }
+    catch (const char *error)
+    {
+        fprintf(stderr, "%s", error);
+        return 1;
+    }
+    return 0;
+}